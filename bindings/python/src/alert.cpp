@@ -79,6 +79,14 @@ list get_status_from_update_alert(state_update_alert const& alert)
    return result;
 }
 
+dict session_stats_delta_values(session_stats_delta_alert const& alert)
+{
+    dict ret;
+    for (int i = 0; i < alert.num_values(); ++i)
+        ret[alert.metric_index(i)] = alert.value(i);
+    return ret;
+}
+
 dict get_params(add_torrent_alert const& alert)
 {
     add_torrent_params const& p = alert.params;
@@ -657,4 +665,12 @@ void bind_alert()
 		 .add_property("routing_table", &dht_stats_routing_table)
         ;
 
+    class_<session_stats_delta_alert, bases<alert>, noncopyable>(
+       "session_stats_delta_alert", no_init)
+        .add_property("values", &session_stats_delta_values)
+        .def("num_values", &session_stats_delta_alert::num_values)
+        .def("metric_index", &session_stats_delta_alert::metric_index)
+        .def("value", &session_stats_delta_alert::value)
+        ;
+
 }
@@ -4,6 +4,7 @@
 
 #include <boost/python.hpp>
 #include <libtorrent/session.hpp>
+#include <libtorrent/bdecode.hpp>
 #include "bytes.hpp"
 
 using namespace boost::python;
@@ -45,6 +46,18 @@ struct entry_to_python
             return convert(e.list());
         case entry::dictionary_t:
             return convert(e.dict());
+        case entry::preformatted_t:
+        {
+            // expand the already bencoded buffer into python objects
+            std::vector<char> const& buf = e.preformatted();
+            bdecode_node n;
+            error_code ec;
+            if (buf.empty() || bdecode(&buf[0], &buf[0] + buf.size(), n, ec) != 0)
+                return object();
+            entry tmp;
+            tmp = n;
+            return convert0(tmp);
+        }
         default:
             return object();
         }
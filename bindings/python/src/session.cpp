@@ -653,6 +653,7 @@ void bind_session()
                 , arg("alert_mask")=int(alert::error_notification)))
         )
         .def("post_torrent_updates", allow_threads(&lt::session::post_torrent_updates))
+        .def("post_session_stats_delta", allow_threads(&lt::session::post_session_stats_delta))
         .def("outgoing_ports", &outgoing_ports)
         .def("is_listening", allow_threads(&lt::session::is_listening))
         .def("listen_port", allow_threads(&lt::session::listen_port))
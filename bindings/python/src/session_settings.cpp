@@ -282,6 +282,7 @@ void bind_session_settings()
         .def_readwrite("max_fail_count", &dht_settings::max_fail_count)
         .def_readwrite("max_torrents", &dht_settings::max_torrents)
         .def_readwrite("max_dht_items", &dht_settings::max_dht_items)
+        .def_readwrite("max_peers", &dht_settings::max_peers)
         .def_readwrite("restrict_routing_ips", &dht_settings::restrict_routing_ips)
         .def_readwrite("restrict_search_ips", &dht_settings::restrict_search_ips)
         .def_readwrite("max_torrent_search_reply", &dht_settings::max_torrent_search_reply)
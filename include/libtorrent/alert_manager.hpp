@@ -47,6 +47,7 @@ POSSIBILITY OF SUCH DAMAGE.
 #include <boost/function/function0.hpp>
 #include <boost/shared_ptr.hpp>
 #include <boost/config.hpp>
+#include <boost/atomic.hpp>
 #include <list>
 #include <utility> // for std::forward
 
@@ -94,10 +95,14 @@ namespace libtorrent {
 				* (1 + T::priority))
 				return;
 
-			T alert(m_allocations[m_generation], std::forward<Args>(args)...);
-			m_alerts[m_generation].push_back(alert);
+			// construct the alert directly in the queue, to not have to copy
+			// it while holding the lock
+			T* alert = m_alerts[m_generation].template emplace_back<T>(
+				m_allocations[m_generation], std::forward<Args>(args)...);
+			m_num_queued_alerts.store(m_alerts[m_generation].size()
+				, boost::memory_order_relaxed);
 
-			maybe_notify(&alert, lock);
+			maybe_notify(alert, lock);
 		}
 
 #else
@@ -111,30 +116,32 @@ namespace libtorrent {
 		bool pending() const;
 		void get_all(std::vector<alert*>& alerts, int& num_resume);
 
+		// this is called before every alert is posted, so it doesn't take the
+		// mutex. The queue size it checks against may be slightly out of date,
+		// emplace_alert() checks it again under the lock
 		template <class T>
 		bool should_post() const
 		{
-			mutex::scoped_lock lock(m_mutex);
-			if (m_alerts[m_generation].size() >= m_queue_size_limit
-				* (1 + T::priority))
+			if ((m_alert_mask.load(boost::memory_order_relaxed)
+				& T::static_category) == 0)
 			{
 				return false;
 			}
-			return (m_alert_mask & T::static_category) != 0;
+			return m_num_queued_alerts.load(boost::memory_order_relaxed)
+				< m_queue_size_limit.load(boost::memory_order_relaxed)
+				* (1 + T::priority);
 		}
 
 		alert* wait_for_alert(time_duration max_wait);
 
 		void set_alert_mask(boost::uint32_t m)
 		{
-			mutex::scoped_lock lock(m_mutex);
-			m_alert_mask = m;
+			m_alert_mask.store(m);
 		}
 
 		boost::uint32_t alert_mask() const
 		{
-			mutex::scoped_lock lock(m_mutex);
-			return m_alert_mask;
+			return m_alert_mask.load();
 		}
 
 		int alert_queue_size_limit() const { return m_queue_size_limit; }
@@ -162,8 +169,15 @@ namespace libtorrent {
 
 		mutable mutex m_mutex;
 		condition_variable m_condition;
-		boost::uint32_t m_alert_mask;
-		int m_queue_size_limit;
+
+		// the mask and the queue size limit are atomic to allow should_post()
+		// to be called without holding the mutex
+		boost::atomic<boost::uint32_t> m_alert_mask;
+		boost::atomic<int> m_queue_size_limit;
+
+		// the number of alerts in m_alerts[m_generation]. This mirrors its
+		// size() but can be read without holding the mutex
+		boost::atomic<int> m_num_queued_alerts;
 
 #ifndef TORRENT_NO_DEPRECATE
 		bool maybe_dispatch(alert const& a);
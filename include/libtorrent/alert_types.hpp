@@ -2355,12 +2355,56 @@ namespace libtorrent
 		int m_size;
 	};
 
+	// The session_stats_delta_alert is posted when the user requests session
+	// statistics by calling post_session_stats_delta() on the session object.
+	// Unlike session_stats_alert, it only holds the metrics whose value changed
+	// since the previous session_stats_delta_alert was posted, which makes it
+	// cheap enough to be sampled at a high frequency. Its category is
+	// ``stats_notification``, but it is not subject to filtering, since it's
+	// only manually posted anyway.
+	//
+	// To reconstruct the full set of metrics, start out with all values being
+	// 0 and update them with every delta alert, in the order they are posted.
+	struct TORRENT_EXPORT session_stats_delta_alert : alert
+	{
+		// internal
+		session_stats_delta_alert(aux::stack_allocator& alloc, counters const& cnt
+			, boost::int64_t* last);
+
+		TORRENT_DEFINE_ALERT_PRIO(session_stats_delta_alert, 87)
+
+		static const int static_category = alert::stats_notification;
+		virtual std::string message() const;
+
+		TORRENT_NOT_DISCARDABLE
+
+		// the number of metrics that changed since the last delta
+		int num_values() const;
+
+		// returns the index of the ``i``:th changed metric. This is the same
+		// index as used by session_stats_alert::values and the mapping returned
+		// by session_stats_metrics().
+		int metric_index(int i) const;
+
+		// returns the new value of the ``i``:th changed metric.
+		boost::int64_t value(int i) const;
+
+	private:
+		aux::stack_allocator& m_alloc;
+
+		// the changed metrics are stored in the stack allocator as an array of
+		// 16 bit metric indices followed by an array of 64 bit values
+		int m_indices_idx;
+		int m_values_idx;
+		int m_num_values;
+	};
+
 #undef TORRENT_DEFINE_ALERT_IMPL
 #undef TORRENT_DEFINE_ALERT
 #undef TORRENT_DEFINE_ALERT_PRIO
 #undef TORRENT_CLONE
 
-	enum { num_alert_types = 87 };
+	enum { num_alert_types = 88 };
 }
 
 
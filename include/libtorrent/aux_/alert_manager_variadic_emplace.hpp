@@ -45,6 +45,8 @@
 				BOOST_PP_COMMA_IF(I)
 				BOOST_PP_ENUM_PARAMS(I, a));
 			m_alerts[m_generation].push_back(alert);
+			m_num_queued_alerts.store(m_alerts[m_generation].size()
+				, boost::memory_order_relaxed);
 
 			maybe_notify(&alert, lock);
 		}
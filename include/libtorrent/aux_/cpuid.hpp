@@ -40,6 +40,7 @@ namespace libtorrent { namespace aux
 	// initialized by static initializers (in cpuid.cpp)
 	TORRENT_EXTRA_EXPORT extern bool sse42_support;
 	TORRENT_EXTRA_EXPORT extern bool mmx_support;
+	TORRENT_EXTRA_EXPORT extern bool sha_support;
 } }
 
 #endif // TORRENT_CPUID_HPP_INCLUDED
@@ -69,6 +69,7 @@ POSSIBILITY OF SUCH DAMAGE.
 #include "libtorrent/tracker_manager.hpp"
 #include "libtorrent/debug.hpp"
 #include "libtorrent/piece_block_progress.hpp"
+#include "libtorrent/piece_picker.hpp" // for piece_block
 #include "libtorrent/ip_filter.hpp"
 #include "libtorrent/config.hpp"
 #include "libtorrent/session_settings.hpp"
@@ -400,6 +401,7 @@ namespace libtorrent
 				, boost::uint32_t flags) const;
 			void post_torrent_updates(boost::uint32_t flags);
 			void post_session_stats();
+			void post_session_stats_delta();
 			void post_dht_stats();
 
 			std::vector<torrent_handle> get_torrents() const;
@@ -593,6 +595,7 @@ namespace libtorrent
 			bool has_lsd() const { return m_lsd.get() != NULL; }
 
 			std::vector<block_info>& block_info_storage() { return m_block_info_storage; }
+			std::vector<piece_block>& picked_blocks_storage() { return m_picked_blocks_storage; }
 
 			libtorrent::utp_socket_manager* utp_socket_manager() { return &m_utp_socket_manager; }
 			void inc_boost_connections() { ++m_boost_connections; }
@@ -664,11 +667,20 @@ namespace libtorrent
 			void on_lsd_peer(tcp::endpoint peer, sha1_hash const& ih);
 			void setup_socket_buffers(socket_type& s);
 
+			// updates the gauges in m_stats_counters that are sampled rather
+			// than being kept up to date continuously
+			void update_stats_gauges();
+
 			// the settings for the client
 			aux::session_settings m_settings;
 
 			counters m_stats_counters;
 
+			// the values of the counters as of the last time a
+			// session_stats_delta_alert was posted. This is allocated the
+			// first time post_session_stats_delta() is called
+			std::vector<boost::int64_t> m_stats_delta_snapshot;
+
 			// this is a pool allocator for torrent_peer objects
 			torrent_peer_allocator m_peer_allocator;
 
@@ -677,6 +689,11 @@ namespace libtorrent
 			// by torrent::get_download_queue.
 			std::vector<block_info> m_block_info_storage;
 
+			// this vector is used by request_blocks() to hold the blocks
+			// picked for a peer. It's kept here to reuse its storage
+			// across calls
+			std::vector<piece_block> m_picked_blocks_storage;
+
 #ifndef TORRENT_DISABLE_POOL_ALLOCATOR
 			// this pool is used to allocate and recycle send
 			// buffers from.
@@ -719,6 +736,10 @@ namespace libtorrent
 			// to distribute its cost to multiple threads
 			std::vector<boost::shared_ptr<network_thread_pool> > m_net_thread_pool;
 
+			// the network thread to assign the next peer to. Peers are
+			// pinned to network threads round-robin
+			int m_next_network_thread;
+
 			// the bandwidth manager is responsible for
 			// handing out bandwidth to connections that
 			// asks for it, it can also throttle the
@@ -82,6 +82,7 @@ namespace libtorrent
 	struct utp_socket_manager;
 	struct socket_type;
 	struct block_info;
+	struct piece_block;
 	struct external_ip;
 	struct torrent_handle;
 	struct ip_filter;
@@ -320,6 +321,7 @@ namespace libtorrent { namespace aux
 		virtual void inc_boost_connections() = 0;
 		virtual void setup_socket_buffers(socket_type& s) = 0;
 		virtual std::vector<block_info>& block_info_storage() = 0;
+		virtual std::vector<piece_block>& picked_blocks_storage() = 0;
 
 #ifdef TORRENT_USE_OPENSSL
 		virtual boost::asio::ssl::context* ssl_ctx() = 0 ;
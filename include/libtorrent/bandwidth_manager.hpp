@@ -94,6 +94,11 @@ private:
 	// the number of bytes all the requests in queue are for
 	boost::int64_t m_queued_bytes;
 
+	// the bandwidth channels with requests in the queue. This is only used
+	// temporarily by update_quotas(), it's a member to reuse its storage
+	// from one tick to the next
+	std::vector<bandwidth_channel*> m_channels;
+
 	// this is the channel within the consumers
 	// that bandwidth is assigned to (upload or download)
 	int m_channel;
@@ -208,6 +208,13 @@ namespace libtorrent
 				write_char(out, 'e');
 				ret += 2;
 				break;
+			case entry::preformatted_t:
+				// the buffer is already bencoded, write it verbatim
+				for (entry::preformatted_type::const_iterator i = e.preformatted().begin();
+					i != e.preformatted().end(); ++i)
+					write_char(out, *i);
+				ret += int(e.preformatted().size());
+				break;
 			default:
 				// trying to encode a structure with uninitialized values!
 //				TORRENT_ASSERT_VAL(false, e.type());
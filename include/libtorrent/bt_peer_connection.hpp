@@ -222,6 +222,9 @@ namespace libtorrent
 		void write_have(int index) TORRENT_OVERRIDE;
 		void write_dont_have(int index) TORRENT_OVERRIDE;
 		void write_piece(peer_request const& r, disk_buffer_holder& buffer) TORRENT_OVERRIDE;
+		void write_file_piece(peer_request const& r
+			, std::vector<open_file_slice> const& slices) TORRENT_OVERRIDE;
+		bool supports_sendfile() const TORRENT_OVERRIDE;
 		void write_keepalive() TORRENT_OVERRIDE;
 		void write_handshake(bool plain_handshake = false);
 #ifndef TORRENT_DISABLE_EXTENSIONS
@@ -254,6 +257,7 @@ namespace libtorrent
 	private:
 
 		bool dispatch_message(int received);
+		void write_piece_header(peer_request const& r);
 		// returns the block currently being
 		// downloaded. And the progress of that
 		// block. If the peer isn't downloading
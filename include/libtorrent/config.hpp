@@ -208,6 +208,14 @@ POSSIBILITY OF SUCH DAMAGE.
 #endif
 
 #define TORRENT_HAVE_MMAP 1
+
+// recvmmsg() was introduced in linux 2.6.33 and glibc 2.12
+#if defined __GLIBC__ && (__GLIBC__ > 2 || (__GLIBC__ == 2 && __GLIBC_MINOR__ >= 12))
+# define TORRENT_USE_RECVMMSG 1
+#endif
+
+#define TORRENT_USE_SENDFILE 1
+
 #define TORRENT_USE_NETLINK 1
 #define TORRENT_USE_IFCONF 1
 #define TORRENT_HAS_SALEN 0
@@ -526,6 +534,14 @@ int snprintf(char* buf, int len, char const* fmt, ...)
 #define TORRENT_HAVE_MMAP 0
 #endif
 
+#ifndef TORRENT_USE_RECVMMSG
+#define TORRENT_USE_RECVMMSG 0
+#endif
+
+#ifndef TORRENT_USE_SENDFILE
+#define TORRENT_USE_SENDFILE 0
+#endif
+
 #ifndef TORRENT_COMPLETE_TYPES_REQUIRED
 #define TORRENT_COMPLETE_TYPES_REQUIRED 0
 #endif
@@ -703,6 +719,25 @@ int snprintf(char* buf, int len, char const* fmt, ...)
 
 #endif // TORRENT_HAS_SSE
 
+// the SHA extensions (SHA-NI) are only available on x86 / amd64. We can use
+// them without requiring the user to enable them for the whole program with
+// compilers that can target individual functions at them (gcc 4.9, clang 3.8)
+// and on msvc 2015. Whether the CPU supports them is determined at runtime
+#ifndef TORRENT_HAS_SHA_NI
+
+#if TORRENT_HAS_SSE \
+	&& ((defined __clang__ && (__clang_major__ > 3 \
+			|| (__clang_major__ == 3 && __clang_minor__ >= 8))) \
+		|| (defined __GNUC__ && !defined __clang__ && (__GNUC__ > 4 \
+			|| (__GNUC__ == 4 && __GNUC_MINOR__ >= 9))) \
+		|| (defined _MSC_VER && _MSC_VER >= 1900))
+#define TORRENT_HAS_SHA_NI 1
+#else
+#define TORRENT_HAS_SHA_NI 0
+#endif
+
+#endif // TORRENT_HAS_SHA_NI
+
 
 #endif // TORRENT_CONFIG_HPP_INCLUDED
 
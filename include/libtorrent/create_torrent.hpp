@@ -409,10 +409,16 @@ namespace libtorrent
 	// 
 	// 	void Fun(int);
 	// 
+	// The pieces are read and hashed by ``num_threads`` threads in parallel (3 unless
+	// specified), with a number of pieces read ahead. Even though pieces may complete out
+	// of order, ``f`` is always called with the piece indices in increasing order.
+	// 
 	// The overloads that don't take an ``error_code&`` may throw an exception in case of a
 	// file error, the other overloads sets the error code to reflect the error, if any.
 	TORRENT_EXPORT void set_piece_hashes(create_torrent& t, std::string const& p
 		, boost::function<void(int)> const& f, error_code& ec);
+	TORRENT_EXPORT void set_piece_hashes(create_torrent& t, std::string const& p
+		, boost::function<void(int)> const& f, int num_threads, error_code& ec);
 	inline void set_piece_hashes(create_torrent& t, std::string const& p, error_code& ec)
 	{
 		set_piece_hashes(t, p, detail::nop, ec);
@@ -96,6 +96,15 @@ namespace libtorrent
 		virtual void async_tick_torrent(piece_manager* storage
 			, boost::function<void(disk_io_job const*)> const& handler) = 0;
 
+		// opens the files the range ``r`` is stored in, for sending it with
+		// sendfile(). The open files and offsets are returned in
+		// ``j->buffer.file_slices``. If the range can't be sent straight from
+		// the files, or some of it is in the cache, the vector is left empty
+		// and it should be read with async_read() instead
+		virtual void async_prepare_sendfile(piece_manager* storage, peer_request const& r
+			, boost::function<void(disk_io_job const*)> const& handler
+			, void* requester) = 0;
+
 		virtual void clear_read_cache(piece_manager* storage) = 0;
 		virtual void async_clear_piece(piece_manager* storage, int index
 			, boost::function<void(disk_io_job const*)> const& handler) = 0;
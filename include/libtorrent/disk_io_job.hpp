@@ -54,6 +54,7 @@ namespace libtorrent
 	struct cached_piece_entry;
 	struct bdecode_node;
 	class torrent_info;
+	struct open_file_slice;
 
 	struct block_cache_reference
 	{
@@ -103,6 +104,7 @@ namespace libtorrent
 			, load_torrent
 			, clear_piece
 			, tick_storage
+			, prepare_sendfile
 			, resolve_links
 
 			, num_job_ids
@@ -135,7 +137,11 @@ namespace libtorrent
 			in_progress = 0x20,
 
 			// turns into file::coalesce_buffers in the file operation
-			coalesce_buffers = 0x40
+			coalesce_buffers = 0x40,
+
+			// the storage has already been told that this read job is
+			// coming up (see storage_interface::hint_read())
+			read_hinted = 0x80
 		};
 
 		// for write jobs, returns true if its block
@@ -154,6 +160,8 @@ namespace libtorrent
 		// for aiocb_complete this points to the aiocb that completed
 		// for get_cache_info this points to a cache_status object which
 		// is filled in
+		// for prepare_sendfile, the open files the requested range is
+		// stored in are returned in the vector this points to
 		union
 		{
 			char* disk_block;
@@ -162,6 +170,7 @@ namespace libtorrent
 			bdecode_node const* check_resume_data;
 			std::vector<boost::uint8_t>* priorities;
 			torrent_info* torrent_file;
+			std::vector<open_file_slice>* file_slices;
 		} buffer;
 
 		// the disk storage this job applies to (if applicable)
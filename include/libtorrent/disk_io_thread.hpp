@@ -293,6 +293,13 @@ namespace libtorrent
 		void set_settings(settings_pack const* sett, alert_manager& alerts);
 		void set_num_threads(int i, bool wait = true);
 
+		// when enabled, generic disk threads also perform queued hash jobs
+		// whenever they have nothing else to do. This is off by default,
+		// in which case hash jobs are only performed by the hasher threads
+		// (every 4th thread). set_piece_hashes() turns it on, since it
+		// doesn't have any other jobs for the generic threads.
+		void set_generic_threads_hash(bool b);
+
 		void async_read(piece_manager* storage, peer_request const& r
 			, boost::function<void(disk_io_job const*)> const& handler, void* requester
 			, int flags = 0);
@@ -336,6 +343,9 @@ namespace libtorrent
 			, boost::function<void(disk_io_job const*)> const& handler);
 		void async_tick_torrent(piece_manager* storage
 			, boost::function<void(disk_io_job const*)> const& handler);
+		void async_prepare_sendfile(piece_manager* storage, peer_request const& r
+			, boost::function<void(disk_io_job const*)> const& handler
+			, void* requester);
 
 		void clear_read_cache(piece_manager* storage);
 		void async_clear_piece(piece_manager* storage, int index
@@ -424,6 +434,7 @@ namespace libtorrent
 		int do_load_torrent(disk_io_job* j, tailqueue& completed_jobs);
 		int do_clear_piece(disk_io_job* j, tailqueue& completed_jobs);
 		int do_tick(disk_io_job* j, tailqueue& completed_jobs);
+		int do_prepare_sendfile(disk_io_job* j, tailqueue& completed_jobs);
 		int do_resolve_links(disk_io_job* j, tailqueue& completed_jobs);
 
 		void call_job_handlers(void* userdata);
@@ -450,6 +461,7 @@ namespace libtorrent
 		void fail_jobs_impl(storage_error const& e, tailqueue& src, tailqueue& dst);
 
 		void check_cache_level(mutex::scoped_lock& l, tailqueue& completed_jobs);
+		void maybe_check_cache_level(tailqueue& completed_jobs);
 
 		void perform_job(disk_io_job* j, tailqueue& completed_jobs);
 
@@ -463,6 +475,17 @@ namespace libtorrent
 		int flush_range(cached_piece_entry* p, int start, int end
 			, tailqueue& completed_jobs, mutex::scoped_lock& l);
 
+		// assumes l is locked (cache mutex).
+		// writes out all dirty blocks of the pieces, sorted by their
+		// position on disk and coalescing adjacent pieces into single
+		// writes. The pieces are expected to be pinned by the caller.
+		// If skip_busy is true, pieces that are being hashed or are no
+		// longer in the write cache when their run is about to be written
+		// are left alone
+		int flush_pieces(cached_piece_entry** pieces, int num_pieces
+			, tailqueue& completed_jobs, mutex::scoped_lock& l
+			, bool skip_busy = false);
+
 		// low level flush operations, used by flush_range
 		int build_iovec(cached_piece_entry* pe, int start, int end
 			, file::iovec_t* iov, int* flushing, int block_base_index = 0);
@@ -587,6 +610,10 @@ namespace libtorrent
 		condition_variable m_hash_job_cond;
 		tailqueue m_queued_hash_jobs;
 
+		// when true, generic threads pick up jobs from m_queued_hash_jobs
+		// once m_queued_jobs is empty. Protected by m_job_mutex
+		bool m_generic_threads_hash;
+
 		// used to rate limit disk performance warnings
 		time_point m_last_disk_aio_performance_warning;
 
@@ -284,6 +284,14 @@ namespace libtorrent
 			// when creating a file, set the executable attribute
 			attribute_executable = 0x400,
 
+			// when opening a file in read_only mode, map it into memory and
+			// serve reads out of the mapping instead of reading with
+			// ``preadv()``. If mapping the file fails, or the operating
+			// system doesn't support it, reads fall back to regular reads.
+			// Reads from parts of the mapping that can't be paged in, because
+			// the file was truncated or the device failed, fail with ``EIO``
+			memory_map = 0x800,
+
 			// the mask of all attribute bits
 			attribute_mask = attribute_hidden | attribute_executable
 		};
@@ -322,6 +330,11 @@ namespace libtorrent
 		boost::int64_t readv(boost::int64_t file_offset, iovec_t const* bufs, int num_bufs
 			, error_code& ec, int flags = 0);
 
+		// tell the operating system that the specified range of the file is
+		// about to be read, to allow it to start reading it in the background.
+		// This is a hint only and never fails.
+		void hint_read(boost::int64_t file_offset, int len);
+
 		boost::int64_t get_size(error_code& ec) const;
 
 		// return the offset of the first byte that
@@ -355,6 +368,14 @@ namespace libtorrent
 #if defined TORRENT_WINDOWS || defined TORRENT_LINUX
 		mutable int m_sector_size;
 #endif
+
+#if TORRENT_HAVE_MMAP
+		// when opened with the memory_map flag, this is the read-only
+		// mapping of the whole file (as of when it was opened), otherwise
+		// NULL
+		char const* m_mapping;
+		boost::int64_t m_mapping_size;
+#endif
 #if defined TORRENT_WINDOWS
 		mutable int m_cluster_size;
 
@@ -366,6 +387,15 @@ namespace libtorrent
 #endif
 	};
 
+	// a range of bytes in an open file. Used to send piece data straight
+	// out of the file it's stored in (see storage_interface::open_file_slices())
+	struct open_file_slice
+	{
+		file_handle file;
+		boost::int64_t offset;
+		int size;
+	};
+
 }
 
 #endif // TORRENT_FILE_HPP_INCLUDED
@@ -41,6 +41,7 @@ POSSIBILITY OF SUCH DAMAGE.
 
 #include <boost/cstdint.hpp>
 #include <boost/unordered_set.hpp>
+#include <boost/unordered_map.hpp>
 
 #include "libtorrent/aux_/disable_warnings_pop.hpp"
 
@@ -419,6 +420,7 @@ namespace libtorrent
 			swap(ti.m_file_base, m_file_base);
 #endif
 			swap(ti.m_paths, m_paths);
+			swap(ti.m_path_index, m_path_index);
 			swap(ti.m_name, m_name);
 			swap(ti.m_total_size, m_total_size);
 			swap(ti.m_num_pieces, m_num_pieces);
@@ -581,6 +583,12 @@ namespace libtorrent
 
 		void update_path_index(internal_file_entry& e, std::string const& path
 			, bool set_name = true);
+		// returns the index of the path in m_paths, adding it if it's not
+		// already there
+		int find_or_add_path(char const* branch_path, int branch_len);
+		// frees the path lookup index. It's rebuilt on demand if more files
+		// are added
+		void free_path_index();
 		void reorder_file(int index, int dst);
 
 		// the list of files that this torrent consists of
@@ -622,6 +630,12 @@ namespace libtorrent
 		// entry appended, to form full file paths
 		std::vector<std::string> m_paths;
 
+		// maps the hash of a path to its index in m_paths, to find existing
+		// paths when adding files without a linear search. This is only a
+		// lookup cache, it's not copied or assigned and it's rebuilt on demand
+		// if it's out of sync with m_paths
+		boost::unordered_multimap<std::size_t, int> m_path_index;
+
 		// name of torrent. For multi-file torrents
 		// this is always the root directory
 		std::string m_name;
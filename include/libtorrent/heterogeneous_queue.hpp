@@ -34,7 +34,9 @@ POSSIBILITY OF SUCH DAMAGE.
 #define TORRENT_HETEROGENEOUS_QUEUE_HPP_INCLUDED
 
 #include <vector>
+#include <utility> // for std::forward
 
+#include <boost/config.hpp>
 #include <boost/cstdint.hpp>
 #include <boost/utility/enable_if.hpp>
 #include <boost/type_traits/is_base_of.hpp>
@@ -53,35 +55,35 @@ namespace libtorrent {
 			, m_num_items(0)
 		{}
 
-		// TODO: 2 add emplace_back() version
 		template <class U>
 		typename boost::enable_if<boost::is_base_of<T, U> >::type
 		push_back(U const& a)
 		{
-			// the size of the type rounded up to pointer alignment
-			const int object_size = (sizeof(U) + sizeof(*m_storage) - 1)
-				/ sizeof(*m_storage);
+			uintptr_t* ptr = allocate_back<U>();
 
-			// +1 for the length prefix
-			if (m_size + object_size + header_size > m_capacity)
-				grow_capacity(object_size);
+			// construct in-place
+			new (ptr) U(a);
 
-			uintptr_t* ptr = m_storage + m_size;
+			commit_back<U>();
+		}
 
-			// length prefix
-			header_t* hdr = reinterpret_cast<header_t*>(ptr);
-			hdr->len = object_size;
-			hdr->move = &move<U>;
-			ptr += header_size;
+#ifndef BOOST_NO_CXX11_VARIADIC_TEMPLATES
+		// constructs a U at the end of the queue in-place, from the arguments
+		// passed in. Returns a pointer to the new object, which stays valid
+		// until the queue grows or is cleared
+		template <class U, typename... Args>
+		typename boost::enable_if<boost::is_base_of<T, U>, U*>::type
+		emplace_back(Args&&... args)
+		{
+			uintptr_t* ptr = allocate_back<U>();
 
 			// construct in-place
-			new (ptr) U(a);
+			U* ret = new (ptr) U(std::forward<Args>(args)...);
 
-			// if we constructed the object without throwing any exception
-			// update counters to indicate the new item is in there
-			++m_num_items;
-			m_size += header_size + object_size;
+			commit_back<U>();
+			return ret;
 		}
+#endif
 
 		void get_pointers(std::vector<T*>& out)
 		{
@@ -163,6 +165,43 @@ namespace libtorrent {
 		const static int header_size = (sizeof(header_t) + sizeof(uintptr_t)
 			- 1) / sizeof(uintptr_t);
 
+		// the size of the type rounded up to pointer alignment
+		template <class U>
+		static int object_size()
+		{
+			return (sizeof(U) + sizeof(uintptr_t) - 1) / sizeof(uintptr_t);
+		}
+
+		// makes room for a U at the end of the storage and writes its
+		// header. Returns a pointer to where the object should be constructed.
+		// Once it has been constructed, commit_back<U>() must be called
+		template <class U>
+		uintptr_t* allocate_back()
+		{
+			const int obj_size = object_size<U>();
+
+			// +1 for the length prefix
+			if (m_size + obj_size + header_size > m_capacity)
+				grow_capacity(obj_size);
+
+			uintptr_t* ptr = m_storage + m_size;
+
+			// length prefix
+			header_t* hdr = reinterpret_cast<header_t*>(ptr);
+			hdr->len = obj_size;
+			hdr->move = &move<U>;
+			return ptr + header_size;
+		}
+
+		// if we constructed the object without throwing any exception
+		// update counters to indicate the new item is in there
+		template <class U>
+		void commit_back()
+		{
+			++m_num_items;
+			m_size += header_size + object_size<U>();
+		}
+
 		void grow_capacity(int size)
 		{
 			int amount_to_grow = (std::max)(size + header_size
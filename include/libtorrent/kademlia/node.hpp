@@ -34,7 +34,7 @@ POSSIBILITY OF SUCH DAMAGE.
 #define NODE_HPP
 
 #include <algorithm>
-#include <map>
+#include <vector>
 #include <set>
 
 #include <libtorrent/config.hpp>
@@ -51,8 +51,13 @@ POSSIBILITY OF SUCH DAMAGE.
 #include <libtorrent/thread.hpp>
 #include <libtorrent/bloom_filter.hpp>
 
+#include "libtorrent/aux_/disable_warnings_push.hpp"
+
 #include <boost/cstdint.hpp>
 #include <boost/ref.hpp>
+#include <boost/unordered_map.hpp>
+
+#include "libtorrent/aux_/disable_warnings_pop.hpp"
 
 #include "libtorrent/socket.hpp"
 
@@ -116,7 +121,11 @@ struct peer_entry
 struct torrent_entry
 {
 	std::string name;
-	std::set<peer_entry> peers;
+
+	// the peers announcing this torrent, sorted by endpoint. A flat array is
+	// used rather than a node based container, since every peer is tiny and
+	// popular torrents have hundreds of them
+	std::vector<peer_entry> peers;
 };
 
 struct dht_immutable_item
@@ -178,7 +187,7 @@ struct count_peers
 {
 	int* count;
 	count_peers(int* c): count(c) {}
-	void operator()(std::pair<libtorrent::dht::node_id
+	void operator()(std::pair<libtorrent::dht::node_id const
 		, libtorrent::dht::torrent_entry> const& t)
 	{
 		*count += t.second.peers.size();
@@ -195,9 +204,9 @@ protected:
 
 class TORRENT_EXTRA_EXPORT node : boost::noncopyable
 {
-typedef std::map<node_id, torrent_entry> table_t;
-typedef std::map<node_id, dht_immutable_item> dht_immutable_table_t;
-typedef std::map<node_id, dht_mutable_item> dht_mutable_table_t;
+typedef boost::unordered_map<node_id, torrent_entry> table_t;
+typedef boost::unordered_map<node_id, dht_immutable_item> dht_immutable_table_t;
+typedef boost::unordered_map<node_id, dht_mutable_item> dht_mutable_table_t;
 
 public:
 	node(udp_socket_interface* sock
@@ -322,6 +331,10 @@ private:
 	table_t m_map;
 	dht_immutable_table_t m_immutable_table;
 	dht_mutable_table_t m_mutable_table;
+
+	// used by incoming_request() to collect the nodes to return in
+	// responses. It's kept across requests to not allocate for every one
+	nodes_t m_nodes_scratch;
 	
 	time_point m_last_tracker_tick;
 
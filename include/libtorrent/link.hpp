@@ -62,6 +62,19 @@ namespace libtorrent
 			index = -1;
 		}
 
+		// like unlink(), but preserves the order of the remaining elements
+		// in the list, at the cost of being linear in the size of the list
+		template <class T>
+		void erase(std::vector<T*>& list, int link_index)
+		{
+			if (index == -1) return;
+			TORRENT_ASSERT(index >= 0 && index < int(list.size()));
+			list.erase(list.begin() + index);
+			for (int i = index; i < int(list.size()); ++i)
+				list[i]->m_links[link_index].index = i;
+			index = -1;
+		}
+
 		template <class T>
 		void insert(std::vector<T*>& list, T* self)
 		{
@@ -37,10 +37,12 @@ POSSIBILITY OF SUCH DAMAGE.
 
 #include "libtorrent/config.hpp"
 
-// RC4 state from libtomcrypt
+// RC4 state from libtomcrypt. The permutation is stored as ints rather
+// than bytes, which avoids partial register stalls and byte stores in the
+// inner loop of rc4_encrypt() (the same choice OpenSSL makes on x86)
 struct rc4 {
-	int x, y;
-	unsigned char buf[256];
+	unsigned int x, y;
+	unsigned int buf[256];
 };
 
 void TORRENT_EXTRA_EXPORT rc4_init(const unsigned char* in, unsigned long len, rc4 *state);
@@ -59,6 +59,7 @@ POSSIBILITY OF SUCH DAMAGE.
 #include "libtorrent/socket.hpp" // for tcp::endpoint
 #include "libtorrent/io_service_fwd.hpp"
 #include "libtorrent/receive_buffer.hpp"
+#include "libtorrent/file.hpp" // for open_file_slice
 
 #ifndef TORRENT_DISABLE_LOGGING
 #include "libtorrent/debug.hpp"
@@ -69,6 +70,7 @@ POSSIBILITY OF SUCH DAMAGE.
 #include <ctime>
 #include <algorithm>
 #include <vector>
+#include <deque>
 #include <string>
 
 #include <boost/smart_ptr.hpp>
@@ -665,6 +667,10 @@ namespace libtorrent
 			, void* userdata = NULL, block_cache_reference ref
 			= block_cache_reference());
 
+		// queues up the range ``s`` of a file to be sent with sendfile(),
+		// after everything that's already in the send buffer
+		void append_send_file(open_file_slice const& s);
+
 #ifndef TORRENT_DISABLE_RESOLVE_COUNTRIES	
 		void set_country(char const* c)
 		{
@@ -677,8 +683,10 @@ namespace libtorrent
 
 		int outstanding_bytes() const { return m_outstanding_bytes; }
 
+		// the number of bytes queued up to be sent, including piece data
+		// that's sent straight from files
 		int send_buffer_size() const
-		{ return m_send_buffer.size(); }
+		{ return m_send_buffer.size() + m_send_file_bytes; }
 
 		int send_buffer_capacity() const
 		{ return m_send_buffer.capacity(); }
@@ -714,6 +722,12 @@ namespace libtorrent
 
 		int num_reading_bytes() const { return m_reading_bytes; }
 
+		// the network thread this peer's socket jobs are posted to, or -1 if
+		// it hasn't been assigned one yet. This is only used by the session
+		// when network_threads is greater than 1
+		int network_thread() const { return m_network_thread; }
+		void set_network_thread(int t) { m_network_thread = t; }
+
 		enum sync_t { read_async, read_sync };
 		void setup_receive();
 
@@ -743,6 +757,13 @@ namespace libtorrent
 		virtual void write_dont_have(int index) = 0;
 		virtual void write_keepalive() = 0;
 		virtual void write_piece(peer_request const& r, disk_buffer_holder& buffer) = 0;
+
+		// like write_piece(), but the payload is sent straight from the
+		// files in ``slices`` with sendfile(). This is only called for
+		// connections that return true from supports_sendfile()
+		virtual void write_file_piece(peer_request const&
+			, std::vector<open_file_slice> const&) { TORRENT_ASSERT(false); }
+		virtual bool supports_sendfile() const { return false; }
 		virtual void write_suggest(int piece) = 0;
 		virtual void write_bitfield() = 0;
 		
@@ -802,6 +823,8 @@ namespace libtorrent
 		void fill_send_buffer();
 		void on_disk_read_complete(disk_io_job const* j, peer_request r
 			, time_point issue_time);
+		void on_sendfile_prepared(disk_io_job const* j, peer_request r);
+		void on_sendfile_writable(error_code const& error, int amount);
 		void on_disk_write_complete(disk_io_job const* j
 			, peer_request r, boost::shared_ptr<torrent> t);
 		void on_seed_mode_hashed(disk_io_job const* j);
@@ -868,6 +891,21 @@ namespace libtorrent
 		chained_buffer m_send_buffer;
 	private:
 
+		// piece data that's sent straight from the files it's stored in,
+		// with sendfile(). ``send_buffer_offset`` is the number of bytes in
+		// m_send_buffer that are sent before the region
+		struct send_file_region
+		{
+			file_handle file;
+			boost::int64_t offset;
+			int size;
+			int send_buffer_offset;
+		};
+		std::deque<send_file_region> m_send_file_regions;
+
+		// the sum of the sizes of all regions in m_send_file_regions
+		int m_send_file_bytes;
+
 		// the disk thread to use to issue disk jobs to
 		disk_interface& m_disk_thread;
 
@@ -1137,6 +1175,11 @@ namespace libtorrent
 		// loops of consistent failures
 		boost::uint8_t m_disk_read_failures;
 
+		// the index of the network thread (pool) socket jobs for this peer
+		// are posted to. Each peer is pinned to one thread, see
+		// session_impl::post_socket_job()
+		boost::int16_t m_network_thread;
+
 		// this is used in seed mode whenever we trigger a hash check
 		// for a piece, before we read it. It's used to throttle
 		// the hash checks to just a few per peer at a time.
@@ -260,6 +260,18 @@ namespace libtorrent
 		// a list of good connect candidates
 		std::vector<torrent_peer*> m_candidate_cache;
 
+		// the number of peers find_connect_candidates() has visited since it
+		// last found a peer it could connect to, or since a new connect
+		// candidate was added. Once this covers the whole peer list, every
+		// candidate is waiting for its reconnect timeout, and there's no
+		// point in scanning again until m_next_reconnect
+		int m_fruitless_scan;
+
+		// the session time at which the first of the connect candidates
+		// skipped by find_connect_candidates() becomes eligible to be
+		// connected to again
+		int m_next_reconnect;
+
 		// The number of peers in our torrent_peer list
 		// that are connect candidates. i.e. they're
 		// not already connected and they have not
@@ -103,6 +103,11 @@ namespace libtorrent
 			piece_picker_rand_loops,
 			piece_picker_busy_loops,
 
+			// the number of times peers asked the piece picker for blocks
+			// to request, and the total time spent in it (in microseconds)
+			piece_picker_calls,
+			piece_picker_time,
+
 			// reasons to disconnect peers
 			connect_timeouts,
 			uninteresting_peers,
@@ -191,6 +196,7 @@ namespace libtorrent
 			num_write_ops,
 			num_read_ops,
 			num_read_back,
+			num_read_hints,
 
 			disk_read_time,
 			disk_write_time,
@@ -253,6 +259,10 @@ namespace libtorrent
 			utp_payload_pkts_out,
 			utp_invalid_pkts_in,
 			utp_redundant_pkts_in,
+			utp_socket_lookups,
+			utp_socket_lookup_probes,
+			utp_packet_pool_hits,
+			utp_packet_pool_misses,
 
 			// the buffer sizes accepted by
 			// socket send calls. The larger
@@ -800,6 +800,14 @@ namespace libtorrent
 		// this is a free-list.
 		std::vector<boost::uint16_t> m_free_block_infos;
 
+		// scratch buffers for pick_pieces(). Blocks that should only be picked
+		// if there aren't enough other ones are collected in these. They're
+		// cleared on entry to pick_pieces() and may hold stale blocks between
+		// calls. They're only kept for their capacity, so picking doesn't hit
+		// the allocator on every request round
+		mutable std::vector<piece_block> m_backup_blocks;
+		mutable std::vector<piece_block> m_backup_blocks2;
+
 		boost::uint16_t m_blocks_per_piece;
 		boost::uint16_t m_blocks_in_last_piece;
 
@@ -374,6 +374,13 @@ namespace libtorrent
 		// For more information, see the session-statistics_ section.
 		void post_session_stats();
 
+		// This function will post a session_stats_delta_alert object,
+		// containing only the performance counters that changed since the last
+		// time this function was called. This is cheaper than
+		// post_session_stats() and is suitable for sampling the counters at a
+		// high frequency.
+		void post_session_stats_delta();
+
 		// This will cause a dht_stats_alert to be posted.
 		void post_dht_stats();
 
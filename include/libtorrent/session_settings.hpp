@@ -1487,6 +1487,7 @@ namespace libtorrent
 			, max_fail_count(20)
 			, max_torrents(2000)
 			, max_dht_items(700)
+			, max_peers(500)
 			, max_torrent_search_reply(20)
 			, restrict_routing_ips(true)
 			, restrict_search_ips(true)
@@ -1528,6 +1529,11 @@ namespace libtorrent
 		// max number of items the DHT will store
 		int max_dht_items;
 
+		// the max number of peers to store per torrent (for the DHT). When a
+		// new peer announces a torrent that's at the limit, the peer that was
+		// heard from the longest time ago is evicted
+		int max_peers;
+
 		// the max number of torrents to return in a torrent search query to the
 		// DHT
 		int max_torrent_search_reply;
@@ -650,6 +650,18 @@ namespace libtorrent
 			// unlikely to matter anyway
 			auto_sequential,
 
+			// when true, piece data requested by peers on unencrypted TCP
+			// connections is sent straight from the files it's stored in, with
+			// ``sendfile()``, rather than being read into disk buffers first.
+			// This saves the copy into user space and keeps the data out of the
+			// disk cache, but ``sendfile()`` runs on the network thread and
+			// will block it if the data is not in the page cache. The files are
+			// told to read ahead when the request is queued, to make this less
+			// likely. Blocks that are in the disk cache are still sent from it.
+			// This is only supported on linux, on other platforms the setting
+			// is ignored.
+			use_sendfile,
+
 			max_bool_setting_internal
 		};
 
@@ -1511,6 +1523,23 @@ namespace libtorrent
 			// .. _i2p: http://www.i2p2.de
 			i2p_port,
 
+			// ``read_ahead_jobs`` is the number of queued read jobs a disk
+			// thread looks at before performing a read. Those reads are hinted
+			// to the storage (see storage_interface::hint_read()), which lets
+			// the operating system issue them in the background. This keeps
+			// more requests in flight to the disk than there are disk threads.
+			// Set this to 0 to disable read hints.
+			read_ahead_jobs,
+
+			// ``max_state_updates`` is the max number of torrent_status objects
+			// posted in a single state_update_alert by
+			// session::post_torrent_updates(). Torrents that don't fit are kept
+			// in the update queue and are posted first by the next call, so
+			// that all torrents are round-robined through the updates. This
+			// bounds the cost of each update when there are a large number of
+			// torrents. 0 means no limit.
+			max_state_updates,
+
 			max_int_setting_internal
 		};
 
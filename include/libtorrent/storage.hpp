@@ -262,6 +262,26 @@ namespace libtorrent
 		virtual int writev(file::iovec_t const* bufs, int num_bufs
 			, int piece, int offset, int flags, storage_error& ec) = 0;
 
+		// This function is called by the disk threads for read jobs that are
+		// still queued, ahead of issuing them. It lets the storage tell the
+		// operating system about upcoming reads, so that the device queue can
+		// be kept full while the disk threads block on other reads. ``flags``
+		// are the same file flags the read will later be issued with. The
+		// default implementation does nothing.
+		virtual void hint_read(int, int, int, int) {}
+
+		// This function is called by the disk threads for peers that send
+		// piece data straight from the files it's stored in (see
+		// settings_pack::use_sendfile). If the ``size`` bytes at ``offset``
+		// into ``piece`` are all stored in regular files, it should append an
+		// open file handle and file offset for each of them to ``slices`` and
+		// return true. Otherwise, or if a file can't be opened, it should
+		// return false, and the data is read with readv() instead. ``flags``
+		// are the file flags readv() would be called with. The default
+		// implementation returns false.
+		virtual bool open_file_slices(int, int, int, int
+			, std::vector<open_file_slice>&) { return false; }
+
 		// This function is called when first checking (or re-checking) the
 		// storage for a torrent. It should return true if any of the files that
 		// is used in this storage exists on disk. If so, the storage will be
@@ -438,6 +458,9 @@ namespace libtorrent
 			, int piece, int offset, int flags, storage_error& ec) TORRENT_OVERRIDE;
 		int writev(file::iovec_t const* bufs, int num_bufs
 			, int piece, int offset, int flags, storage_error& ec) TORRENT_OVERRIDE;
+		virtual void hint_read(int piece, int offset, int len, int flags) TORRENT_OVERRIDE;
+		virtual bool open_file_slices(int piece, int offset, int size, int flags
+			, std::vector<open_file_slice>& slices) TORRENT_OVERRIDE;
 
 		// if the files in this storage are mapped, returns the mapped
 		// file_storage, otherwise returns the original file_storage object.
@@ -501,6 +524,34 @@ namespace libtorrent
 		bool m_allocate_files;
 	};
 
+	// this is a default_storage that serves reads out of read-only memory
+	// mappings of the files, rather than issuing a read system call per
+	// block. This mostly makes sense for seeding, where files are opened in
+	// read-only mode, in combination with disabling the read cache
+	// (settings_pack::use_read_cache) to let the operating system's page
+	// cache be the only cache of the file data. Files opened for writing are
+	// not mapped and are accessed the same way as default_storage does.
+	//
+	// If a mapped file is truncated by another process, or the device fails
+	// to read from it, the ``SIGBUS`` raised by reading the mapping is caught
+	// and the read fails with an I/O error, just like a failed regular read.
+	//
+	// .. warning:: this installs a process wide ``SIGBUS`` handler the first
+	//    time a file is mapped, which passes signals it doesn't handle on to
+	//    the previous handler. If the application installs its own ``SIGBUS``
+	//    handler after that, it has to do the same, or reads from truncated
+	//    files will terminate the process.
+	class TORRENT_EXPORT mmap_storage : public default_storage
+	{
+	public:
+		explicit mmap_storage(storage_params const& params)
+			: default_storage(params) {}
+
+		virtual int readv(file::iovec_t const* bufs, int num_bufs
+			, int piece, int offset, int flags, storage_error& ec) TORRENT_OVERRIDE;
+		virtual void hint_read(int piece, int offset, int len, int flags) TORRENT_OVERRIDE;
+	};
+
 	// this storage implementation does not write anything to disk
 	// and it pretends to read, and just leaves garbage in the buffers
 	// this is useful when simulating many clients on the same machine
@@ -601,6 +652,15 @@ namespace libtorrent
 		int job_complete(disk_io_job* j, tailqueue& job_queue);
 		int num_outstanding_jobs() const { return m_outstanding_jobs; }
 
+		// counts the caller as an outstanding job on this storage, to let
+		// a disk thread access it outside of a job without racing with
+		// fence jobs. Returns false (without taking a reference) if there
+		// is a fence up. Every successful call must be paired with a call
+		// to unpin(), which, like job_complete(), may hand back the fence
+		// job that was waiting for this reference to be released.
+		bool try_pin();
+		int unpin(tailqueue& job_queue);
+
 		// if there is a fence up, returns true and adds the job
 		// to the queue of blocked jobs
 		bool is_blocked(disk_io_job* j);
@@ -609,6 +669,10 @@ namespace libtorrent
 		int num_blocked() const;
 
 	private:
+		// posts the fence job at the front of m_blocked_jobs, once
+		// the last outstanding job has completed. m_mutex must be held
+		int post_fence_job(tailqueue& job_queue);
+
 		// when > 0, this storage is blocked for new async
 		// operations until all outstanding jobs have completed.
 		// at that point, the m_blocked_jobs are issued
@@ -90,6 +90,10 @@ namespace libtorrent
 	TORRENT_EXPORT storage_interface* disabled_storage_constructor(storage_params const&);
 
 	TORRENT_EXPORT storage_interface* zero_storage_constructor(storage_params const&);
+
+	// the constructor function for mmap_storage, the regular file storage,
+	// but serving reads out of read-only memory mappings of the files.
+	TORRENT_EXPORT storage_interface* mmap_storage_constructor(storage_params const&);
 }
 
 #endif
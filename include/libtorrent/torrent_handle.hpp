@@ -614,7 +614,16 @@ namespace libtorrent
 			// priorities having changed etc. If the resume data doesn't need
 			// saving, a save_resume_data_failed_alert is posted with the error
 			// resume_data_not_modified.
-			only_if_modified = 4
+			only_if_modified = 4,
+
+			// when the metadata is saved in the resume data (see
+			// save_info_dict), store the ``info`` key as an entry of type
+			// ``entry::preformatted_t``, holding the bencoded info-dictionary
+			// verbatim, instead of expanding it into a dictionary. This is a lot
+			// cheaper for large torrents. bencode() writes it out unchanged,
+			// but the client can't call dict() on it without decoding the
+			// buffer first.
+			preformatted_info_dict = 8
 		};
 
 		// ``save_resume_data()`` generates fast-resume data and returns it as an
@@ -752,6 +752,13 @@ namespace libtorrent
 		// pointing to the first byte of the first sha-1 hash
 		char const* m_piece_hashes;
 
+		// the "ssl-cert" string of the info-dictionary, if any. It's located
+		// when parsing the info section, so that ssl_cert() doesn't need to
+		// decode the whole info-dictionary again. The pointer points directly
+		// into the info_section buffer and must be corrected when copied. The
+		// int is the length of the string.
+		std::pair<char const*, int> m_ssl_cert;
+
 		// if a comment is found in the torrent file
 		// this will be set to that comment
 		std::string m_comment;
@@ -191,7 +191,7 @@ namespace libtorrent
 		void setup_read(udp::socket* s);
 		void on_read(error_code const& ec, udp::socket* s);
 		void on_read_impl(udp::endpoint const& ep
-			, error_code const& e, std::size_t bytes_transferred);
+			, error_code const& e, char const* buf, std::size_t bytes_transferred);
 		void on_name_lookup(error_code const& e, tcp::resolver::iterator i);
 		void on_connect_timeout(error_code const& ec);
 		void on_connected(error_code const& ec);
@@ -220,8 +220,19 @@ namespace libtorrent
 		// the desired size, and it's resized
 		// later
 		int m_new_buf_size;
+
+		// the receive buffer. When receiving datagrams in batches (with
+		// recvmmsg()) this holds read_batch_size(m_buf_size) slots of
+		// m_buf_size bytes each, one per datagram
 		char* m_buf;
 
+#if TORRENT_USE_RECVMMSG
+		// this is set while the datagrams of a batch are handed to the
+		// observers. m_buf cannot be reallocated until they've all been
+		// delivered
+		bool m_buf_in_use;
+#endif
+
 #if TORRENT_USE_IPV6
 		udp::socket m_ipv6_sock;
 #endif
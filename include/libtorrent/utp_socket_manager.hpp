@@ -33,9 +33,14 @@ POSSIBILITY OF SUCH DAMAGE.
 #ifndef TORRENT_UTP_SOCKET_MANAGER_HPP_INCLUDED
 #define TORRENT_UTP_SOCKET_MANAGER_HPP_INCLUDED
 
-#include <map>
+#include "libtorrent/aux_/disable_warnings_push.hpp"
+
+#include <boost/unordered_map.hpp>
+
+#include "libtorrent/aux_/disable_warnings_pop.hpp"
 
 #include "libtorrent/socket_type.hpp"
+#include "libtorrent/utp_stream.hpp" // for TORRENT_ETHERNET_MTU
 #include "libtorrent/session_status.hpp"
 #include "libtorrent/enum_net.hpp"
 #include "libtorrent/aux_/session_settings.hpp"
@@ -91,6 +96,13 @@ namespace libtorrent
 
 		void mtu_for_dest(address const& addr, int& link_mtu, int& utp_mtu);
 		void set_sock_buf(int size);
+
+		// allocate and free the memory backing uTP packets. Buffers of up to
+		// packet_buffer_size bytes are recycled on a free-list rather than
+		// being returned to the heap. ``size`` passed to free_packet() must be
+		// the same as the one passed to alloc_packet()
+		void* alloc_packet(int size);
+		void free_packet(void* p, int size);
 		int num_sockets() const { return m_utp_sockets.size(); }
 
 		void defer_ack(utp_socket_impl* s);
@@ -100,6 +112,17 @@ namespace libtorrent
 		// the counter is the enum from ``counters``.
 		void inc_stats_counter(int counter, int delta = 1);
 
+		enum
+		{
+			// the size of the buffers kept in the packet pool. This is large
+			// enough for a full ethernet MTU sized packet, including the
+			// packet bookkeeping
+			packet_buffer_size = TORRENT_ETHERNET_MTU + 64,
+
+			// the max number of free buffers to keep in the packet pool
+			max_pooled_packets = 512
+		};
+
 	private:
 		// explicitly disallow assignment, to silence msvc warning
 		utp_socket_manager& operator=(utp_socket_manager const&);
@@ -107,10 +130,14 @@ namespace libtorrent
 		udp_socket& m_sock;
 		incoming_utp_callback_t m_cb;
 
-		// replace with a hash-map
-		typedef std::multimap<boost::uint16_t, utp_socket_impl*> socket_map_t;
+		// all uTP sockets, keyed by their receive connection ID. Sockets
+		// sharing a connection ID are told apart by their remote endpoint
+		typedef boost::unordered_multimap<boost::uint16_t, utp_socket_impl*> socket_map_t;
 		socket_map_t m_utp_sockets;
 
+		// free packet buffers, each packet_buffer_size bytes
+		std::vector<void*> m_packet_pool;
+
 		// this is a list of sockets that needs to send an ack.
 		// once the UDP socket is drained, all of these will
 		// have a chance to do that. This is to avoid sending
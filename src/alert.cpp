@@ -1270,8 +1270,10 @@ namespace libtorrent {
 
 	state_update_alert::state_update_alert(aux::stack_allocator&
 		, std::vector<torrent_status> st)
-		: status(st)
-	{}
+	{
+		// take over the buffer, the status vector may be large
+		status.swap(st);
+	}
 
 	std::string state_update_alert::message() const
 	{
@@ -1608,6 +1610,74 @@ namespace libtorrent {
 		return msg;
 	}
 
+	session_stats_delta_alert::session_stats_delta_alert(aux::stack_allocator& alloc
+		, counters const& cnt, boost::int64_t* last)
+		: m_alloc(alloc)
+		, m_indices_idx(0)
+		, m_values_idx(0)
+		, m_num_values(0)
+	{
+		int num_changed = 0;
+		for (int i = 0; i < counters::num_counters; ++i)
+			if (cnt[i] != last[i]) ++num_changed;
+
+		if (num_changed == 0) return;
+
+		m_indices_idx = alloc.allocate(num_changed * sizeof(boost::uint16_t));
+		m_values_idx = alloc.allocate(num_changed * sizeof(boost::int64_t));
+
+		// the stack allocator doesn't guarantee any alignment, so the entries
+		// are copied in and out with memcpy
+		char* indices = alloc.ptr(m_indices_idx);
+		char* values = alloc.ptr(m_values_idx);
+		for (int i = 0; i < counters::num_counters; ++i)
+		{
+			boost::int64_t const v = cnt[i];
+			if (v == last[i]) continue;
+			last[i] = v;
+
+			boost::uint16_t const idx = boost::uint16_t(i);
+			memcpy(indices, &idx, sizeof(idx));
+			memcpy(values, &v, sizeof(v));
+			indices += sizeof(idx);
+			values += sizeof(v);
+			++m_num_values;
+
+			// the counters may be updated by other threads while we're doing
+			// this, in which case we just don't report the late changes until
+			// the next delta
+			if (m_num_values == num_changed) break;
+		}
+	}
+
+	int session_stats_delta_alert::num_values() const
+	{
+		return m_num_values;
+	}
+
+	int session_stats_delta_alert::metric_index(int i) const
+	{
+		TORRENT_ASSERT(i >= 0 && i < m_num_values);
+		boost::uint16_t ret;
+		memcpy(&ret, m_alloc.ptr(m_indices_idx) + i * sizeof(ret), sizeof(ret));
+		return ret;
+	}
+
+	boost::int64_t session_stats_delta_alert::value(int i) const
+	{
+		TORRENT_ASSERT(i >= 0 && i < m_num_values);
+		boost::int64_t ret;
+		memcpy(&ret, m_alloc.ptr(m_values_idx) + i * sizeof(ret), sizeof(ret));
+		return ret;
+	}
+
+	std::string session_stats_delta_alert::message() const
+	{
+		char msg[100];
+		snprintf(msg, sizeof(msg), "session stats delta (%d values)", m_num_values);
+		return msg;
+	}
+
 	dht_stats_alert::dht_stats_alert(aux::stack_allocator&
 		, std::vector<dht_routing_bucket> const& table
 		, std::vector<dht_lookup> const& requests)
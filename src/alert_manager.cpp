@@ -44,6 +44,7 @@ namespace libtorrent
 	alert_manager::alert_manager(int queue_limit, boost::uint32_t alert_mask)
 		: m_alert_mask(alert_mask)
 		, m_queue_size_limit(queue_limit)
+		, m_num_queued_alerts(0)
 		, m_num_queued_resume(0)
 		, m_generation(0)
 	{}
@@ -121,6 +122,7 @@ namespace libtorrent
 
 		heterogeneous_queue<alert> storage;
 		m_alerts[m_generation].swap(storage);
+		m_num_queued_alerts.store(0, boost::memory_order_relaxed);
 		lock.unlock();
 
 		std::vector<alert*> alerts;
@@ -170,6 +172,7 @@ namespace libtorrent
 		// clear the one we will start writing to now
 		m_alerts[m_generation].clear();
 		m_allocations[m_generation].reset();
+		m_num_queued_alerts.store(0, boost::memory_order_relaxed);
 	}
 
 	bool alert_manager::pending() const
@@ -180,10 +183,7 @@ namespace libtorrent
 
 	int alert_manager::set_alert_queue_size_limit(int queue_size_limit_)
 	{
-		mutex::scoped_lock lock(m_mutex);
-
-		std::swap(m_queue_size_limit, queue_size_limit_);
-		return queue_size_limit_;
+		return m_queue_size_limit.exchange(queue_size_limit_);
 	}
 
 }
@@ -155,12 +155,16 @@ namespace libtorrent
 
 		// for each bandwidth channel, call update_quota(dt)
 
-		std::vector<bandwidth_channel*> channels;
+		m_channels.clear();
 
 		queue_t tm;
 
-		for (queue_t::iterator i = m_queue.begin();
-			i != m_queue.end();)
+		// requests that are removed from the queue are moved to tm, and the
+		// remaining ones are compacted towards the front (preserving their
+		// order) as we go. This keeps each pass linear in the queue size
+		queue_t::iterator out = m_queue.begin();
+		for (queue_t::iterator i = m_queue.begin(), end(m_queue.end());
+			i != end; ++i)
 		{
 			if (i->peer->is_disconnecting())
 			{
@@ -176,7 +180,6 @@ namespace libtorrent
 
 				i->assigned = 0;
 				tm.push_back(*i);
-				i = m_queue.erase(i);
 				continue;
 			}
 			for (int j = 0; j < bw_request::max_bandwidth_channels && i->channel[j]; ++j)
@@ -184,8 +187,10 @@ namespace libtorrent
 				bandwidth_channel* bwc = i->channel[j];
 				bwc->tmp = 0;
 			}
-			++i;
+			if (out != i) *out = *i;
+			++out;
 		}
+		m_queue.erase(out, m_queue.end());
 
 		for (queue_t::iterator i = m_queue.begin()
 			, end(m_queue.end()); i != end; ++i)
@@ -193,20 +198,21 @@ namespace libtorrent
 			for (int j = 0; j < bw_request::max_bandwidth_channels && i->channel[j]; ++j)
 			{
 				bandwidth_channel* bwc = i->channel[j];
-				if (bwc->tmp == 0) channels.push_back(bwc);
+				if (bwc->tmp == 0) m_channels.push_back(bwc);
 				TORRENT_ASSERT(INT_MAX - bwc->tmp > i->priority);
 				bwc->tmp += i->priority;
 			}
 		}
 
-		for (std::vector<bandwidth_channel*>::iterator i = channels.begin()
-			, end(channels.end()); i != end; ++i)
+		for (std::vector<bandwidth_channel*>::iterator i = m_channels.begin()
+			, end(m_channels.end()); i != end; ++i)
 		{
 			(*i)->update_quota(int(dt_milliseconds));
 		}
 
-		for (queue_t::iterator i = m_queue.begin();
-			i != m_queue.end();)
+		out = m_queue.begin();
+		for (queue_t::iterator i = m_queue.begin(), end(m_queue.end());
+			i != end; ++i)
 		{
 			int a = i->assign_bandwidth();
 			if (i->assigned == i->request_size
@@ -215,14 +221,15 @@ namespace libtorrent
 				a += i->request_size - i->assigned;
 				TORRENT_ASSERT(i->assigned <= i->request_size);
 				tm.push_back(*i);
-				i = m_queue.erase(i);
 			}
 			else
 			{
-				++i;
+				if (out != i) *out = *i;
+				++out;
 			}
 			m_queued_bytes -= a;
 		}
+		m_queue.erase(out, m_queue.end());
 
 		while (!tm.empty())
 		{
@@ -205,6 +205,7 @@ const char* const job_action_name[] =
 	"load_torrent",
 	"clear_piece",
 	"tick_storage",
+	"prepare_sendfile",
 	"resolve_links"
 };
 
@@ -2483,12 +2483,10 @@ namespace libtorrent
 
 	} // anonymous namespace
 
-	void bt_peer_connection::write_piece(peer_request const& r, disk_buffer_holder& buffer)
+	// writes the piece message header for the request ``r``. The payload
+	// is appended by the caller
+	void bt_peer_connection::write_piece_header(peer_request const& r)
 	{
-		INVARIANT_CHECK;
-
-		TORRENT_ASSERT(m_sent_handshake && m_sent_bitfield);
-
 		boost::shared_ptr<torrent> t = associated_torrent().lock();
 		TORRENT_ASSERT(t);
 
@@ -2539,6 +2537,15 @@ namespace libtorrent
 		{
 			send_buffer(msg, 13);
 		}
+	}
+
+	void bt_peer_connection::write_piece(peer_request const& r, disk_buffer_holder& buffer)
+	{
+		INVARIANT_CHECK;
+
+		TORRENT_ASSERT(m_sent_handshake && m_sent_bitfield);
+
+		write_piece_header(r);
 
 		if (buffer.ref().storage == 0)
 		{
@@ -2558,6 +2565,46 @@ namespace libtorrent
 		stats_counters().inc_stats_counter(counters::num_outgoing_piece);
 	}
 
+	void bt_peer_connection::write_file_piece(peer_request const& r
+		, std::vector<open_file_slice> const& slices)
+	{
+		INVARIANT_CHECK;
+
+		TORRENT_ASSERT(m_sent_handshake && m_sent_bitfield);
+		TORRENT_ASSERT(supports_sendfile());
+
+		write_piece_header(r);
+
+		for (std::vector<open_file_slice>::const_iterator i = slices.begin()
+			, end(slices.end()); i != end; ++i)
+		{
+			append_send_file(*i);
+		}
+
+		m_payloads.push_back(range(send_buffer_size() - r.length, r.length));
+		setup_send();
+
+		stats_counters().inc_stats_counter(counters::num_outgoing_piece);
+	}
+
+	bool bt_peer_connection::supports_sendfile() const
+	{
+#if TORRENT_USE_SENDFILE
+		if (!m_settings.get_bool(settings_pack::use_sendfile)) return false;
+
+#if !defined(TORRENT_DISABLE_ENCRYPTION) && !defined(TORRENT_DISABLE_EXTENSIONS)
+		// the payload has to go out unmodified
+		if (m_encrypted) return false;
+#endif
+
+		// sendfile() needs the file descriptor of a plain TCP socket. This
+		// excludes SSL, uTP and proxied connections
+		return get_socket()->get<tcp::socket>() != NULL;
+#else
+		return false;
+#endif
+	}
+
 	// --------------------------
 	// RECEIVE DATA
 	// --------------------------
@@ -42,10 +42,39 @@ namespace libtorrent
 
 	namespace {
 
+	// the unchoker operates on these rather than on the peer_connection
+	// objects directly. The values that are compared most often are
+	// sampled once per unchoke round, instead of once per comparison.
+	// Computing the upload priority of a peer means walking its peer
+	// classes and the ones of its torrent, which is too expensive to do
+	// O(n log n) times with tens of thousands of peers.
+	struct unchoke_candidate
+	{
+		explicit unchoke_candidate(peer_connection* p)
+			: peer(p)
+			, prio(p->get_priority(peer_connection::upload_channel))
+			, downloaded(p->downloaded_in_last_round())
+			, uploaded(p->uploaded_in_last_round())
+		{}
+
+		peer_connection* peer;
+
+		// the upload priority of the peer
+		int prio;
+
+		// the number of payload bytes received from and sent to this peer
+		// in the last unchoke round
+		boost::int64_t downloaded;
+		boost::int64_t uploaded;
+	};
+
 	// return true if 'lhs' peer should be preferred to be unchoke over 'rhs'
-	bool unchoke_compare_rr(peer_connection const* lhs
-		, peer_connection const* rhs, int pieces)
+	bool unchoke_compare_rr(unchoke_candidate const& lc
+		, unchoke_candidate const& rc, int pieces)
 	{
+		peer_connection const* lhs = lc.peer;
+		peer_connection const* rhs = rc.peer;
+
 		// if one peer belongs to a higher priority torrent than the other one
 		// that one should be unchoked.
 		boost::shared_ptr<torrent> t1 = lhs->associated_torrent().lock();
@@ -53,8 +82,8 @@ namespace libtorrent
 		boost::shared_ptr<torrent> t2 = rhs->associated_torrent().lock();
 		TORRENT_ASSERT(t2);
 
-		int prio1 = lhs->get_priority(peer_connection::upload_channel);
-		int prio2 = rhs->get_priority(peer_connection::upload_channel);
+		int prio1 = lc.prio;
+		int prio2 = rc.prio;
 
 		if (prio1 != prio2)
 			return prio1 > prio2;
@@ -62,8 +91,8 @@ namespace libtorrent
 		// compare how many bytes they've sent us
 		boost::int64_t c1;
 		boost::int64_t c2;
-		c1 = lhs->downloaded_in_last_round();
-		c2 = rhs->downloaded_in_last_round();
+		c1 = lc.downloaded;
+		c2 = rc.downloaded;
 
 		if (c1 != c2) return c1 > c2;
 
@@ -106,9 +135,12 @@ namespace libtorrent
 	}
 
 	// return true if 'lhs' peer should be preferred to be unchoke over 'rhs'
-	bool unchoke_compare_fastest_upload(peer_connection const* lhs
-		, peer_connection const* rhs)
+	bool unchoke_compare_fastest_upload(unchoke_candidate const& lc
+		, unchoke_candidate const& rc)
 	{
+		peer_connection const* lhs = lc.peer;
+		peer_connection const* rhs = rc.peer;
+
 		// if one peer belongs to a higher priority torrent than the other one
 		// that one should be unchoked.
 		boost::shared_ptr<torrent> t1 = lhs->associated_torrent().lock();
@@ -116,8 +148,8 @@ namespace libtorrent
 		boost::shared_ptr<torrent> t2 = rhs->associated_torrent().lock();
 		TORRENT_ASSERT(t2);
 
-		int prio1 = lhs->get_priority(peer_connection::upload_channel);
-		int prio2 = rhs->get_priority(peer_connection::upload_channel);
+		int prio1 = lc.prio;
+		int prio2 = rc.prio;
 
 		if (prio1 != prio2)
 			return prio1 > prio2;
@@ -125,14 +157,14 @@ namespace libtorrent
 		// compare how many bytes they've sent us
 		boost::int64_t c1;
 		boost::int64_t c2;
-		c1 = lhs->downloaded_in_last_round();
-		c2 = rhs->downloaded_in_last_round();
+		c1 = lc.downloaded;
+		c2 = rc.downloaded;
 
 		if (c1 != c2) return c1 > c2;
 
 		// when seeding, prefer the peer we're uploading the fastest to
-		c1 = lhs->uploaded_in_last_round();
-		c2 = rhs->uploaded_in_last_round();
+		c1 = lc.uploaded;
+		c2 = rc.uploaded;
 	
 		// take torrent priority into account
 		c1 *= prio1;
@@ -148,9 +180,12 @@ namespace libtorrent
 	}
 
 	// return true if 'lhs' peer should be preferred to be unchoke over 'rhs'
-	bool unchoke_compare_anti_leech(peer_connection const* lhs
-		, peer_connection const* rhs)
+	bool unchoke_compare_anti_leech(unchoke_candidate const& lc
+		, unchoke_candidate const& rc)
 	{
+		peer_connection const* lhs = lc.peer;
+		peer_connection const* rhs = rc.peer;
+
 		// if one peer belongs to a higher priority torrent than the other one
 		// that one should be unchoked.
 		boost::shared_ptr<torrent> t1 = lhs->associated_torrent().lock();
@@ -158,8 +193,8 @@ namespace libtorrent
 		boost::shared_ptr<torrent> t2 = rhs->associated_torrent().lock();
 		TORRENT_ASSERT(t2);
 
-		int prio1 = lhs->get_priority(peer_connection::upload_channel);
-		int prio2 = rhs->get_priority(peer_connection::upload_channel);
+		int prio1 = lc.prio;
+		int prio2 = rc.prio;
 
 		if (prio1 != prio2)
 			return prio1 > prio2;
@@ -167,8 +202,8 @@ namespace libtorrent
 		// compare how many bytes they've sent us
 		boost::int64_t c1;
 		boost::int64_t c2;
-		c1 = lhs->downloaded_in_last_round();
-		c2 = rhs->downloaded_in_last_round();
+		c1 = lc.downloaded;
+		c2 = rc.downloaded;
 
 		if (c1 != c2) return c1 > c2;
 
@@ -207,37 +242,31 @@ namespace libtorrent
 		return lhs->time_of_last_unchoke() < rhs->time_of_last_unchoke();
 	}
 
-	bool upload_rate_compare(peer_connection const* lhs
-		, peer_connection const* rhs)
+	bool upload_rate_compare(unchoke_candidate const& lhs
+		, unchoke_candidate const& rhs)
 	{
-		boost::int64_t c1;
-		boost::int64_t c2;
-
-		c1 = lhs->uploaded_in_last_round();
-		c2 = rhs->uploaded_in_last_round();
-		
 		// take torrent priority into account
-		c1 *= lhs->get_priority(peer_connection::upload_channel);
-		c2 *= rhs->get_priority(peer_connection::upload_channel);
+		boost::int64_t c1 = lhs.uploaded * lhs.prio;
+		boost::int64_t c2 = rhs.uploaded * rhs.prio;
 
 		return c1 > c2;
 	}
 
-	bool bittyrant_unchoke_compare(peer_connection const* lhs
-		, peer_connection const* rhs)
+	bool bittyrant_unchoke_compare(unchoke_candidate const& lhs
+		, unchoke_candidate const& rhs)
 	{
 		boost::int64_t d1, d2, u1, u2;
 
 		// first compare how many bytes they've sent us
-		d1 = lhs->downloaded_in_last_round();
-		d2 = rhs->downloaded_in_last_round();
+		d1 = lhs.downloaded;
+		d2 = rhs.downloaded;
 		// divided by the number of bytes we've sent them
-		u1 = lhs->uploaded_in_last_round();
-		u2 = rhs->uploaded_in_last_round();
+		u1 = lhs.uploaded;
+		u2 = rhs.uploaded;
 
 		// take torrent priority into account
-		d1 *= lhs->get_priority(peer_connection::upload_channel);
-		d2 *= rhs->get_priority(peer_connection::upload_channel);
+		d1 *= lhs.prio;
+		d2 *= rhs.prio;
 
 		d1 = d1 * 1000 / (std::max)(boost::int64_t(1), u1);
 		d2 = d2 * 1000 / (std::max)(boost::int64_t(1), u2);
@@ -246,9 +275,29 @@ namespace libtorrent
 
 		// if both peers are still in their send quota or not in their send quota
 		// prioritize the one that has waited the longest to be unchoked
-		return lhs->time_of_last_unchoke() < rhs->time_of_last_unchoke();
+		return lhs.peer->time_of_last_unchoke() < rhs.peer->time_of_last_unchoke();
 	}
 
+	// extends the sorted prefix of ``v`` from ``sorted`` to ``n`` elements
+	// and returns the new length of the sorted prefix. The elements past
+	// it are left in unspecified order, but all of them rank lower than
+	// the ones in the prefix, which is what makes it possible to extend it
+	// again later. This lets the callers that walk the candidates in order
+	// and stop after the first few hundred avoid sorting all of them.
+	template <class Compare>
+	int extend_sorted_prefix(std::vector<unchoke_candidate>& v, int sorted
+		, int n, Compare cmp)
+	{
+		n = (std::min)(n, int(v.size()));
+		if (n <= sorted) return sorted;
+		std::partial_sort(v.begin() + sorted, v.begin() + n, v.end(), cmp);
+		return n;
+	}
+
+	// the number of candidates to sort at a time, when we don't know up
+	// front how many of them we'll need
+	const int unchoke_sort_chunk = 64;
+
 	} // anonymous namespace
 
 	int unchoke_sort(std::vector<peer_connection*>& peers
@@ -288,23 +337,39 @@ namespace libtorrent
 					p->increase_est_reciprocation_rate();
 				}
 			}
+		}
 
-			// if we're using the bittyrant choker, sort peers by their return
-			// on investment. i.e. download rate / upload rate
-			std::sort(peers.begin(), peers.end()
-				, boost::bind(&bittyrant_unchoke_compare, _1, _2));
+		std::vector<unchoke_candidate> candidates;
+		candidates.reserve(peers.size());
+		for (std::vector<peer_connection*>::const_iterator i = peers.begin()
+			, end(peers.end()); i != end; ++i)
+		{
+			candidates.push_back(unchoke_candidate(*i));
+		}
 
+		if (sett.get_int(settings_pack::choking_algorithm)
+			== settings_pack::bittyrant_choker)
+		{
 			int upload_capacity_left = max_upload_rate;
 
 			// now, figure out how many peers should be unchoked. We deduct the
 			// estimated reciprocation rate from our upload_capacity estimate
-			// until there none left
+			// until there none left. The peers are visited in order of their
+			// return on investment. i.e. download rate / upload rate. Only as
+			// many of them as we end up visiting are sorted.
 			upload_slots = 0;
+			int sorted = 0;
 
-			for (std::vector<peer_connection*>::iterator i = peers.begin()
-				, end(peers.end()); i != end; ++i)
+			for (int i = 0; i < int(candidates.size()); ++i)
 			{
-				peer_connection* p = *i;
+				if (i == sorted)
+				{
+					sorted = extend_sorted_prefix(candidates, sorted
+						, (std::max)(sorted * 2, unchoke_sort_chunk)
+						, boost::bind(&bittyrant_unchoke_compare, _1, _2));
+				}
+
+				peer_connection* p = candidates[i].peer;
 				TORRENT_ASSERT(p);
 
 				if (p->est_reciprocation_rate() > upload_capacity_left) break;
@@ -313,6 +378,9 @@ namespace libtorrent
 				upload_capacity_left -= p->est_reciprocation_rate();
 			}
 
+			for (int i = 0; i < int(candidates.size()); ++i)
+				peers[i] = candidates[i].peer;
+
 			return upload_slots;
 		}
 
@@ -332,23 +400,21 @@ namespace libtorrent
 			// first reset the number of unchoke slots, because we'll calculate
 			// it purely based on the current state of our peers.
 			upload_slots = 0;
-
-			// TODO: optimize this using partial_sort or something. We don't need
-			// to sort the entire list
-			
-			// TODO: make the comparison function a free function and move it
-			// into this cpp file
-			std::sort(peers.begin(), peers.end()
-				, boost::bind(&upload_rate_compare, _1, _2));
+			int sorted = 0;
 
 			// TODO: make configurable
 			int rate_threshold = 1024;
 
-			for (std::vector<peer_connection*>::const_iterator i = peers.begin()
-				, end(peers.end()); i != end; ++i)
+			for (int i = 0; i < int(candidates.size()); ++i)
 			{
-				peer_connection const& p = **i;
-				int rate = int(p.uploaded_in_last_round()
+				if (i == sorted)
+				{
+					sorted = extend_sorted_prefix(candidates, sorted
+						, (std::max)(sorted * 2, unchoke_sort_chunk)
+						, boost::bind(&upload_rate_compare, _1, _2));
+				}
+
+				int rate = int(candidates[i].uploaded
 					* 1000 / total_milliseconds(unchoke_interval));
 
 				if (rate < rate_threshold) break;
@@ -365,31 +431,33 @@ namespace libtorrent
 		// secondary by total upload. The reason for this is, if all torrents are
 		// being seeded, the download rate will be 0, and the peers we have sent
 		// the least to should be unchoked
-		
+
 		// we use partial sort here, because we only care about the top
-		// upload_slots peers.
+		// upload_slots peers. A negative number of slots means unlimited
+		int const num_sorted = upload_slots < 0 ? int(candidates.size())
+			: (std::min)(upload_slots, int(candidates.size()));
 
 		if (sett.get_int(settings_pack::seed_choking_algorithm)
 			== settings_pack::round_robin)
 		{
 			int pieces = sett.get_int(settings_pack::seeding_piece_quota);
 
-			std::partial_sort(peers.begin(), peers.begin()
-				+ (std::min)(upload_slots, int(peers.size())), peers.end()
+			std::partial_sort(candidates.begin(), candidates.begin()
+				+ num_sorted, candidates.end()
 				, boost::bind(&unchoke_compare_rr, _1, _2, pieces));
 		}
 		else if (sett.get_int(settings_pack::seed_choking_algorithm)
 			== settings_pack::fastest_upload)
 		{
-			std::partial_sort(peers.begin(), peers.begin()
-				+ (std::min)(upload_slots, int(peers.size())), peers.end()
+			std::partial_sort(candidates.begin(), candidates.begin()
+				+ num_sorted, candidates.end()
 				, boost::bind(&unchoke_compare_fastest_upload, _1, _2));
 		}
 		else if (sett.get_int(settings_pack::seed_choking_algorithm)
 			== settings_pack::anti_leech)
 		{
-			std::partial_sort(peers.begin(), peers.begin()
-				+ (std::min)(upload_slots, int(peers.size())), peers.end()
+			std::partial_sort(candidates.begin(), candidates.begin()
+				+ num_sorted, candidates.end()
 				, boost::bind(&unchoke_compare_anti_leech, _1, _2));
 		}
 		else
@@ -397,11 +465,14 @@ namespace libtorrent
 			TORRENT_ASSERT(false && "unknown seed choking algorithm");
 
 			int pieces = sett.get_int(settings_pack::seeding_piece_quota);
-			std::partial_sort(peers.begin(), peers.begin()
-				+ (std::min)(upload_slots, int(peers.size())), peers.end()
+			std::partial_sort(candidates.begin(), candidates.begin()
+				+ num_sorted, candidates.end()
 				, boost::bind(&unchoke_compare_rr, _1, _2, pieces));
 		}
 
+		for (int i = 0; i < int(candidates.size()); ++i)
+			peers[i] = candidates[i].peer;
+
 		return upload_slots;
 	}
 
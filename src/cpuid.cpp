@@ -82,10 +82,29 @@ namespace libtorrent { namespace aux
 #endif
 	}
 
+	// the SHA extensions, as well as the SSSE3 and SSE4.1 instructions the
+	// SHA-1 transform needs to go with them
+	bool supports_sha()
+	{
+#if TORRENT_HAS_SSE
+		unsigned int cpui[4];
+		cpuid(cpui, 0);
+		if (cpui[0] < 7) return false;
+		cpuid(cpui, 1);
+		if ((cpui[2] & (1 << 9)) == 0 || (cpui[2] & (1 << 19)) == 0)
+			return false;
+		cpuid(cpui, 7);
+		return cpui[1] & (1 << 29);
+#else
+		return false;
+#endif
+	}
+
 	} // anonymous namespace
 
 	bool sse42_support = supports_sse42();
 	bool mmx_support = supports_mmx();
+	bool sha_support = supports_sha();
 } }
 
 
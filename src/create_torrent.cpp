@@ -39,6 +39,7 @@ POSSIBILITY OF SUCH DAMAGE.
 #include "libtorrent/torrent_info.hpp"
 #include "libtorrent/performance_counters.hpp" // for counters
 #include "libtorrent/alert_manager.hpp"
+#include "libtorrent/bitfield.hpp"
 
 #include <boost/bind.hpp>
 #include <boost/next_prior.hpp>
@@ -159,34 +160,56 @@ namespace libtorrent
 			}
 		}
 
-		void on_hash(disk_io_job const* j, create_torrent* t
-			, boost::shared_ptr<piece_manager> storage, disk_io_thread* iothread
-			, int* piece_counter, int* completed_piece
-			, boost::function<void(int)> const* f, error_code* ec)
+		struct hash_state
 		{
+			create_torrent& ct;
+			boost::shared_ptr<piece_manager> storage;
+			disk_io_thread& iothread;
+			int piece_counter;
+			int completed_piece;
+			boost::function<void(int)> const& f;
+			error_code& ec;
+			// one bit per piece, set once its hash is done. Since the disk
+			// threads may complete the hash jobs out of order, this is used
+			// to report progress in piece order
+			bitfield hashed;
+		};
+
+		void on_hash(disk_io_job const* j, hash_state* st)
+		{
+			// once we've failed, don't issue any more jobs. The ones still
+			// outstanding just complete
+			if (st->ec) return;
+
 			if (j->ret != 0)
 			{
 				// on error
-				*ec = j->error.ec;
-				iothread->set_num_threads(0);
+				st->ec = j->error.ec;
+				st->iothread.set_num_threads(0);
 				return;
 			}
-			t->set_hash(j->piece, sha1_hash(j->d.piece_hash));
-			(*f)(*completed_piece);
-			++(*completed_piece);
-			if (*piece_counter < t->num_pieces())
+			st->ct.set_hash(j->piece, sha1_hash(j->d.piece_hash));
+			st->hashed.set_bit(j->piece);
+
+			while (st->completed_piece < st->ct.num_pieces()
+				&& st->hashed.get_bit(st->completed_piece))
 			{
-				iothread->async_hash(storage.get(), *piece_counter
+				st->f(st->completed_piece);
+				++st->completed_piece;
+			}
+
+			if (st->piece_counter < st->ct.num_pieces())
+			{
+				st->iothread.async_hash(st->storage.get(), st->piece_counter
 					, disk_io_job::sequential_access
-					, boost::bind(&on_hash, _1, t, storage, iothread
-					, piece_counter, completed_piece, f, ec), (void*)0);
-				++(*piece_counter);
+					, boost::bind(&on_hash, _1, st), (void*)0);
+				++st->piece_counter;
 			}
-			else
+			else if (st->completed_piece == st->ct.num_pieces())
 			{
-				iothread->set_num_threads(0);
+				st->iothread.set_num_threads(0);
 			}
-			iothread->submit_jobs();
+			st->iothread.submit_jobs();
 		}
 
 	} // anonymous namespace
@@ -244,6 +267,12 @@ namespace libtorrent
 
 	void set_piece_hashes(create_torrent& t, std::string const& p
 		, boost::function<void(int)> const& f, error_code& ec)
+	{
+		set_piece_hashes(t, p, f, 3, ec);
+	}
+
+	void set_piece_hashes(create_torrent& t, std::string const& p
+		, boost::function<void(int)> const& f, int num_threads, error_code& ec)
 	{
 		// optimized path
 		io_service ios;
@@ -285,18 +314,26 @@ namespace libtorrent
 		alert_manager dummy2(0, 0);
 		disk_thread.set_settings(&sett, dummy2);
 
-		int piece_counter = 0;
-		int completed_piece = 0;
-		int piece_read_ahead = 15 * 1024 * 1024 / t.piece_length();
-		if (piece_read_ahead < 1) piece_read_ahead = 1;
+		// hashing is the only thing these threads do, make sure all of them
+		// get to, not just the hasher threads
+		disk_thread.set_generic_threads_hash(true);
+		if (num_threads < 1) num_threads = 1;
+		disk_thread.set_num_threads(num_threads);
+
+		hash_state st = { t, storage, disk_thread, 0, 0, f, ec
+			, bitfield(t.num_pieces(), false) };
+
+		// keep enough hash jobs outstanding for every thread to always have
+		// the next piece queued up while it's hashing the current one
+		int piece_read_ahead = (std::max)(15 * 1024 * 1024 / t.piece_length()
+			, num_threads * 4);
 
 		for (int i = 0; i < piece_read_ahead; ++i)
 		{
 			disk_thread.async_hash(storage.get(), i, disk_io_job::sequential_access
-				, boost::bind(&on_hash, _1, &t, storage, &disk_thread
-				, &piece_counter, &completed_piece, &f, &ec), (void*)0);
-			++piece_counter;
-			if (piece_counter >= t.num_pieces()) break;
+				, boost::bind(&on_hash, _1, &st), (void*)0);
+			++st.piece_counter;
+			if (st.piece_counter >= t.num_pieces()) break;
 		}
 		disk_thread.submit_jobs();
 		ios.run(ec);
@@ -64,6 +64,8 @@ namespace libtorrent
 			free(buffer.string);
 		else if (action == save_resume_data)
 			delete (entry*)buffer.resume_data;
+		else if (action == prepare_sendfile)
+			delete buffer.file_slices;
 	}
 
 	bool disk_io_job::completed(cached_piece_entry const* pe, int block_size)
@@ -123,6 +123,46 @@ namespace libtorrent
 		return ret;
 	}
 
+	// a read job, queued behind the one a disk thread is about to perform,
+	// that the storage will be told about ahead of time
+	struct read_hint
+	{
+		boost::shared_ptr<piece_manager> storage;
+		int piece;
+		int offset;
+		int length;
+		int flags;
+	};
+
+	// look at (at most) the first ``limit`` read jobs in ``queue`` and record
+	// the ones whose storage hasn't been hinted about them yet. The caller
+	// must hold the mutex protecting the queue. The storage of every
+	// recorded hint is pinned, and must be unpinned once the hint has been
+	// issued. Storages with a fence up are skipped, they may be in the
+	// middle of moving or closing their files
+	void collect_read_hints(tailqueue const& queue, int limit
+		, std::vector<read_hint>& hints)
+	{
+		for (tailqueue_iterator i = queue.iterate(); i.get() && limit > 0; i.next())
+		{
+			disk_io_job* j = const_cast<disk_io_job*>(
+				static_cast<disk_io_job const*>(i.get()));
+			if (j->action != disk_io_job::read) continue;
+			--limit;
+			if (j->flags & disk_io_job::read_hinted) continue;
+			if (!j->storage->try_pin()) continue;
+			j->flags |= disk_io_job::read_hinted;
+
+			read_hint h;
+			h.storage = j->storage;
+			h.piece = j->piece;
+			h.offset = j->d.io.offset;
+			h.length = j->d.io.buffer_size;
+			h.flags = file_flags_for_job(j);
+			hints.push_back(h);
+		}
+	}
+
 	} // anonymous namespace
 
 // ------- disk_io_thread ------
@@ -141,6 +181,7 @@ namespace libtorrent
 		, m_stats_counters(cnt)
 		, m_ios(ios)
 		, m_work(io_service::work(m_ios))
+		, m_generic_threads_hash(false)
 		, m_last_disk_aio_performance_warning(min_time())
 		, m_outstanding_reclaim_message(false)
 #if TORRENT_USE_ASSERTS
@@ -236,6 +277,13 @@ namespace libtorrent
 		}
 	}
 
+	void disk_io_thread::set_generic_threads_hash(bool b)
+	{
+		mutex::scoped_lock l(m_job_mutex);
+		m_generic_threads_hash = b;
+		if (b && !m_queued_hash_jobs.empty()) m_job_cond.notify_all();
+	}
+
 	char* disk_io_thread::async_allocate_disk_buffer(char const* category
 		, boost::function<void(char*)> const& handler)
 	{ return m_disk_cache.async_allocate_buffer(category, handler); }
@@ -757,6 +805,135 @@ namespace libtorrent
 		return iov_len;
 	}
 
+	namespace {
+
+	// orders pieces by their position on disk. Pieces of a storage are laid
+	// out sequentially, so within one storage this is the piece index order
+	bool compare_disk_position(cached_piece_entry const* lhs
+		, cached_piece_entry const* rhs)
+	{
+		if (lhs->storage != rhs->storage) return lhs->storage < rhs->storage;
+		return lhs->piece < rhs->piece;
+	}
+
+	// the max number of blocks to coalesce into a single write across
+	// adjacent pieces (16 MiB with the default block size). A single piece
+	// larger than this is still flushed as one write
+	const int max_coalesced_blocks = 1024;
+
+	// pieces that another thread is hashing, or that another thread flushed
+	// and evicted into the read cache while the cache mutex was released
+	bool is_busy(cached_piece_entry const* pe)
+	{
+		return pe->num_dirty == 0
+			|| pe->hashing
+			|| pe->cache_state != cached_piece_entry::write_lru;
+	}
+
+	} // anonymous namespace
+
+	// flushes all dirty blocks of the pieces in the array. The pieces are
+	// sorted by their position on disk, and runs of adjacent pieces in the
+	// same storage are written as a single iovec, which lets the storage issue
+	// large sequential writes across piece (and file) boundaries instead of
+	// one write per piece. The caller is expected to have incremented the
+	// piece_refcount of every piece, and is responsible for releasing them.
+	// Returns the number of blocks flushed.
+	int disk_io_thread::flush_pieces(cached_piece_entry** pieces, int num_pieces
+		, tailqueue& completed_jobs, mutex::scoped_lock& l, bool skip_busy)
+	{
+		TORRENT_ASSERT(l.locked());
+		INVARIANT_CHECK;
+
+		if (num_pieces == 0) return 0;
+
+		std::sort(pieces, pieces + num_pieces, &compare_disk_position);
+
+		int max_blocks = max_coalesced_blocks;
+		for (int i = 0; i < num_pieces; ++i)
+		{
+			TORRENT_PIECE_ASSERT(pieces[i]->piece_refcount > 0, pieces[i]);
+			max_blocks = (std::max)(max_blocks, int(pieces[i]->blocks_in_piece));
+		}
+
+		file::iovec_t* iov = TORRENT_ALLOCA(file::iovec_t, max_blocks);
+		int* flushing = TORRENT_ALLOCA(int, max_blocks);
+		// this is the offset into iov and flushing for each piece in the
+		// current run
+		int* iovec_offset = TORRENT_ALLOCA(int, num_pieces + 1);
+
+		int ret = 0;
+		int run_start = 0;
+		while (run_start < num_pieces)
+		{
+			// the cache mutex was released while writing the previous run,
+			// so whether a piece is busy has to be checked right before
+			// building the iovec for its run
+			if (skip_busy && is_busy(pieces[run_start]))
+			{
+				++run_start;
+				continue;
+			}
+
+			cached_piece_entry* first = pieces[run_start];
+			int run_end = run_start;
+			int num_blocks = 0;
+			int iov_len = 0;
+
+			// extend the run for as long as the next piece follows the previous
+			// one on disk. The block indices are relative to the first piece of
+			// the run, which is what flush_iovec() expects
+			do
+			{
+				cached_piece_entry* pe = pieces[run_end];
+				iovec_offset[run_end] = iov_len;
+				iov_len += build_iovec(pe, 0, pe->blocks_in_piece
+					, iov + iov_len, flushing + iov_len
+					, (pe->piece - first->piece) * first->blocks_in_piece);
+				num_blocks += pe->blocks_in_piece;
+				++run_end;
+			} while (run_end < num_pieces
+				&& pieces[run_end]->storage == first->storage
+				&& pieces[run_end]->piece == pieces[run_end - 1]->piece + 1
+				&& num_blocks + pieces[run_end]->blocks_in_piece <= max_blocks
+				&& !(skip_busy && is_busy(pieces[run_end])));
+			iovec_offset[run_end] = iov_len;
+
+			if (iov_len > 0)
+			{
+				DLOG("flush_pieces: pieces [%d, %d] blocks: %d\n"
+					, int(first->piece), int(pieces[run_end - 1]->piece), iov_len);
+
+				l.unlock();
+
+				storage_error error;
+				flush_iovec(first, iov, flushing, iov_len, error);
+
+				l.lock();
+
+				for (int i = run_start; i < run_end; ++i)
+				{
+					cached_piece_entry* pe = pieces[i];
+					int const n = iovec_offset[i + 1] - iovec_offset[i];
+					if (n == 0) continue;
+					iovec_flushed(pe, flushing + iovec_offset[i], n
+						, (pe->piece - first->piece) * first->blocks_in_piece
+						, error, completed_jobs);
+				}
+				ret += iov_len;
+			}
+
+			run_start = run_end;
+		}
+
+		// if the cache is under high pressure, we need to evict
+		// the blocks we just flushed to make room for more write pieces
+		int evict = m_disk_cache.num_to_evict(0);
+		if (evict > 0) m_disk_cache.try_evict_blocks(evict);
+
+		return ret;
+	}
+
 	void disk_io_thread::fail_jobs(storage_error const& e, tailqueue& jobs_)
 	{
 		tailqueue jobs;
@@ -824,6 +1001,39 @@ namespace libtorrent
 				piece_index.push_back((*i)->piece);
 			}
 
+			if ((flags & flush_write_cache) && (flags & flush_delete_cache) == 0)
+			{
+				// write all dirty pieces in disk order first, so adjacent
+				// pieces are coalesced into large writes. flush_piece() below
+				// then only has to deal with the read cache
+				std::vector<cached_piece_entry*> dirty;
+				dirty.reserve(piece_index.size());
+				for (std::vector<int>::iterator i = piece_index.begin()
+					, end(piece_index.end()); i != end; ++i)
+				{
+					cached_piece_entry* pe = m_disk_cache.find_piece(storage, *i);
+					if (pe == NULL || pe->num_dirty == 0) continue;
+#if TORRENT_USE_ASSERTS
+					pe->piece_log.push_back(piece_log_t(piece_log_t::flushing, -1));
+#endif
+					++pe->piece_refcount;
+					dirty.push_back(pe);
+				}
+
+				if (!dirty.empty())
+				{
+					flush_pieces(&dirty[0], int(dirty.size()), completed_jobs, l);
+
+					for (std::vector<cached_piece_entry*>::iterator i = dirty.begin()
+						, end(dirty.end()); i != end; ++i)
+					{
+						TORRENT_PIECE_ASSERT((*i)->piece_refcount > 0, *i);
+						--(*i)->piece_refcount;
+						m_disk_cache.maybe_free_piece(*i);
+					}
+				}
+			}
+
 			for (std::vector<int>::iterator i = piece_index.begin()
 				, end(piece_index.end()); i != end; ++i)
 			{
@@ -925,7 +1135,10 @@ namespace libtorrent
 		if (num == 0 || m_stats_counters[counters::num_writing_threads] > 0) return;
 
 		// if we still need to flush blocks, start over and flush
-		// everything in LRU order (degrade to lru cache eviction)
+		// everything (degrade to lru cache eviction). The pieces are written
+		// in disk order, coalescing adjacent ones
+		std::vector<cached_piece_entry*> to_flush;
+		to_flush.reserve(pieces.size());
 		for (std::vector<std::pair<piece_manager*, int> >::iterator i = pieces.begin()
 			, end(pieces.end()); i != end; ++i)
 		{
@@ -944,11 +1157,19 @@ namespace libtorrent
 			pe->piece_log.push_back(piece_log_t(piece_log_t::try_flush_write_blocks2, -1));
 #endif
 			++pe->piece_refcount;
+			to_flush.push_back(pe);
+		}
 
-			num -= flush_range(pe, 0, INT_MAX, completed_jobs, l);
-			--pe->piece_refcount;
+		if (to_flush.empty()) return;
 
-			m_disk_cache.maybe_free_piece(pe);
+		flush_pieces(&to_flush[0], int(to_flush.size()), completed_jobs, l, true);
+
+		for (std::vector<cached_piece_entry*>::iterator i = to_flush.begin()
+			, end(to_flush.end()); i != end; ++i)
+		{
+			TORRENT_PIECE_ASSERT((*i)->piece_refcount > 0, *i);
+			--(*i)->piece_refcount;
+			m_disk_cache.maybe_free_piece(*i);
 		}
 	}
 
@@ -991,9 +1212,10 @@ namespace libtorrent
 			if (num_flush == 200) break;
 		}
 
+		flush_pieces(to_flush, num_flush, completed_jobs, l);
+
 		for (int i = 0; i < num_flush; ++i)
 		{
-			flush_range(to_flush[i], 0, INT_MAX, completed_jobs, l);
 			TORRENT_ASSERT(to_flush[i]->piece_refcount > 0);
 			--to_flush[i]->piece_refcount;
 			m_disk_cache.maybe_free_piece(to_flush[i]);
@@ -1029,6 +1251,7 @@ namespace libtorrent
 		&disk_io_thread::do_load_torrent,
 		&disk_io_thread::do_clear_piece,
 		&disk_io_thread::do_tick,
+		&disk_io_thread::do_prepare_sendfile,
 	};
 
 	} // anonymous namespace
@@ -1057,15 +1280,25 @@ namespace libtorrent
 		}
 	}
 
+	// every disk thread checks the cache level before and after each job.
+	// Whether anything needs to be evicted is known by the buffer pool
+	// (under its own mutex), so only take the cache mutex when it does, to
+	// avoid contending on it twice per job
+	void disk_io_thread::maybe_check_cache_level(tailqueue& completed_jobs)
+	{
+		if (m_disk_cache.num_to_evict(0) == 0) return;
+
+		mutex::scoped_lock l(m_cache_mutex);
+		check_cache_level(l, completed_jobs);
+	}
+
 	void disk_io_thread::perform_job(disk_io_job* j, tailqueue& completed_jobs)
 	{
 		INVARIANT_CHECK;
 		TORRENT_ASSERT(j->next == 0);
 		TORRENT_ASSERT((j->flags & disk_io_job::in_progress) || !j->storage);
 
-		mutex::scoped_lock l(m_cache_mutex);
-
-		check_cache_level(l, completed_jobs);
+		maybe_check_cache_level(completed_jobs);
 
 		DLOG("perform_job job: %s ( %s%s) piece: %d offset: %d outstanding: %d\n"
 			, job_action_name[j->action]
@@ -1074,8 +1307,6 @@ namespace libtorrent
 			, j->piece, j->d.io.offset
 			, j->storage ? j->storage->num_outstanding_jobs() : -1);
 
-		l.unlock();
-
 		boost::shared_ptr<piece_manager> storage = j->storage;
 
 		// TODO: instead of doing this. pass in the settings to each storage_interface
@@ -1124,7 +1355,7 @@ namespace libtorrent
 		if (j->action == disk_io_job::hash && !j->error.ec)
 		{
 			// a hash job should never return without clearing pe->hash
-			l.lock();
+			mutex::scoped_lock l(m_cache_mutex);
 			cached_piece_entry* pe = m_disk_cache.find_piece(j);
 			if (pe != NULL)
 			{
@@ -2046,6 +2277,31 @@ namespace libtorrent
 		add_job(j);
 	}
 
+	void disk_io_thread::async_prepare_sendfile(piece_manager* storage
+		, peer_request const& r
+		, boost::function<void(disk_io_job const*)> const& handler
+		, void* requester)
+	{
+#ifdef TORRENT_DEBUG
+		// the caller must increment the torrent refcount before
+		// issuing an async disk request
+		storage->assert_torrent_refcount();
+#endif
+
+		TORRENT_ASSERT(r.length <= m_disk_cache.block_size());
+
+		disk_io_job* j = allocate_job(disk_io_job::prepare_sendfile);
+		j->storage = storage->shared_from_this();
+		j->piece = r.piece;
+		j->d.io.offset = r.start;
+		j->d.io.buffer_size = r.length;
+		j->buffer.file_slices = new std::vector<open_file_slice>();
+		j->requester = requester;
+		j->callback = handler;
+
+		add_job(j);
+	}
+
 	void disk_io_thread::clear_read_cache(piece_manager* storage)
 	{
 		mutex::scoped_lock l(m_cache_mutex);
@@ -2973,10 +3229,6 @@ namespace libtorrent
 		}
 		else
 		{
-			// do this to trigger parsing of the info-dict here. It's better
-			// than to have it be done in the network thread. It has enough to
-			// do as it is.
-			std::string cert = t->ssl_cert();
 			j->buffer.torrent_file = t;
 		}
 
@@ -3030,6 +3282,35 @@ namespace libtorrent
 		return j->storage->get_storage_impl()->tick();
 	}
 
+	int disk_io_thread::do_prepare_sendfile(disk_io_job* j, tailqueue& /* completed_jobs */ )
+	{
+		TORRENT_ASSERT(j->buffer.file_slices != NULL);
+
+		// blocks in the cache may not have been written to the file yet, and
+		// the ones that have are cheaper to send from the cache anyway. If
+		// any part of the range is cached, leave the slices empty to make the
+		// peer read it the regular way
+		mutex::scoped_lock l(m_cache_mutex);
+		cached_piece_entry* pe = m_disk_cache.find_piece(j);
+		if (pe != NULL)
+		{
+			int const block_size = m_disk_cache.block_size();
+			int const start = j->d.io.offset / block_size;
+			int const end = (j->d.io.offset + j->d.io.buffer_size
+				+ block_size - 1) / block_size;
+			for (int i = start; i < end; ++i)
+			{
+				if (pe->blocks[i].buf != NULL) return 0;
+			}
+		}
+		l.unlock();
+
+		j->storage->get_storage_impl()->open_file_slices(j->piece
+			, j->d.io.offset, j->d.io.buffer_size, file_flags_for_job(j)
+			, *j->buffer.file_slices);
+		return 0;
+	}
+
 	void disk_io_thread::add_fence_job(piece_manager* storage, disk_io_job* j)
 	{
 		// if this happens, it means we started to shut down
@@ -3140,7 +3421,10 @@ namespace libtorrent
 	void disk_io_thread::submit_jobs()
 	{
 		mutex::scoped_lock l(m_job_mutex);
-		if (!m_queued_jobs.empty())
+		// generic threads may also pick up hash jobs when they're idle, in
+		// which case, wake them up for those as well
+		if (!m_queued_jobs.empty()
+			|| (m_generic_threads_hash && !m_queued_hash_jobs.empty()))
 			m_job_cond.notify_all();
 		if (!m_queued_hash_jobs.empty())
 			m_hash_job_cond.notify_all();
@@ -3153,6 +3437,10 @@ namespace libtorrent
 		++m_num_running_threads;
 		m_stats_counters.inc_stats_counter(counters::num_running_threads, 1);
 
+		// scratch space for read hints, kept across jobs to avoid
+		// allocating it once per read
+		std::vector<read_hint> hints;
+
 		mutex::scoped_lock l(m_job_mutex);
 		for (;;)
 		{
@@ -3160,7 +3448,9 @@ namespace libtorrent
 			if (type == generic_thread)
 			{
 				TORRENT_ASSERT(l.locked());
-				while (m_queued_jobs.empty() && thread_id < m_num_threads) m_job_cond.wait(l);
+				while (m_queued_jobs.empty()
+					&& (!m_generic_threads_hash || m_queued_hash_jobs.empty())
+					&& thread_id < m_num_threads) m_job_cond.wait(l);
 
 				// if the number of wanted threads is decreased,
 				// we may stop this thread
@@ -3172,7 +3462,12 @@ namespace libtorrent
 					break;
 				}
 
-				j = (disk_io_job*)m_queued_jobs.pop_front();
+				// when there's nothing else to do, generic threads may help
+				// the hasher threads out with their queue
+				if (!m_queued_jobs.empty() || !m_generic_threads_hash)
+					j = (disk_io_job*)m_queued_jobs.pop_front();
+				else
+					j = (disk_io_job*)m_queued_hash_jobs.pop_front();
 			}
 			else if (type == hasher_thread)
 			{
@@ -3182,8 +3477,49 @@ namespace libtorrent
 				j = (disk_io_job*)m_queued_hash_jobs.pop_front();
 			}
 
+			// while this thread blocks on its read, let the storage issue the
+			// reads queued up behind it, to keep more requests in flight on
+			// the device than there are disk threads
+			int const read_ahead = m_settings.get_int(settings_pack::read_ahead_jobs);
+			if (type == generic_thread && read_ahead > 0
+				&& j->action == disk_io_job::read)
+			{
+				collect_read_hints(m_queued_jobs, read_ahead, hints);
+			}
+
 			l.unlock();
 
+			if (!hints.empty())
+			{
+				// the hinted jobs may complete on other threads while we're
+				// doing this. The pin taken on their storage keeps any fence
+				// job from running on it until we're done
+				tailqueue fence_jobs;
+				int unblocked = 0;
+				for (std::vector<read_hint>::iterator i = hints.begin()
+					, end(hints.end()); i != end; ++i)
+				{
+					i->storage->get_storage_impl()->hint_read(i->piece, i->offset
+						, i->length, i->flags);
+					unblocked += i->storage->unpin(fence_jobs);
+				}
+				m_stats_counters.inc_stats_counter(counters::num_read_hints
+					, hints.size());
+				hints.clear();
+
+				if (unblocked > 0)
+				{
+					m_stats_counters.inc_stats_counter(counters::blocked_disk_jobs
+						, -unblocked);
+					l.lock();
+					// fence jobs are prioritized, since they're blocking
+					// other jobs
+					m_queued_jobs.prepend(fence_jobs);
+					m_job_cond.notify_all();
+					l.unlock();
+				}
+			}
+
 			TORRENT_ASSERT((j->flags & disk_io_job::in_progress) || !j->storage);
 
 			if (thread_id == 0)
@@ -3208,9 +3544,7 @@ namespace libtorrent
 			tailqueue completed_jobs;
 			perform_job(j, completed_jobs);
 
-			mutex::scoped_lock l2(m_cache_mutex);
-			check_cache_level(l2, completed_jobs);
-			l2.unlock();
+			maybe_check_cache_level(completed_jobs);
 
 			if (completed_jobs.size())
 				add_completed_jobs(completed_jobs);
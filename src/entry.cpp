@@ -254,6 +254,31 @@ namespace libtorrent
 		return *reinterpret_cast<const dictionary_type*>(data);
 	}
 
+	entry::preformatted_type& entry::preformatted()
+	{
+		if (m_type == undefined_t) construct(preformatted_t);
+#ifndef BOOST_NO_EXCEPTIONS
+		if (m_type != preformatted_t) throw_type_error();
+#elif defined TORRENT_DEBUG
+		TORRENT_ASSERT(m_type_queried);
+#endif
+		TORRENT_ASSERT(m_type == preformatted_t);
+		void* storage = data;
+		return *static_cast<preformatted_type*>(storage);
+	}
+
+	entry::preformatted_type const& entry::preformatted() const
+	{
+#ifndef BOOST_NO_EXCEPTIONS
+		if (m_type != preformatted_t) throw_type_error();
+#elif defined TORRENT_DEBUG
+		TORRENT_ASSERT(m_type_queried);
+#endif
+		TORRENT_ASSERT(m_type == preformatted_t);
+		void const* storage = data;
+		return *static_cast<preformatted_type const*>(storage);
+	}
+
 	entry::entry()
 		: m_type(undefined_t)
 	{
@@ -320,6 +345,16 @@ namespace libtorrent
 		m_type = int_t;
 	}
 
+	entry::entry(preformatted_type const& v)
+		: m_type(undefined_t)
+	{
+#ifdef TORRENT_DEBUG
+		m_type_queried = true;
+#endif
+		new(data) preformatted_type(v);
+		m_type = preformatted_t;
+	}
+
 	// convert a bdecode_node into an old skool entry
 	void entry::operator=(bdecode_node const& e)
 	{
@@ -436,6 +471,16 @@ namespace libtorrent
 #endif
 	}
 
+	void entry::operator=(preformatted_type const& v)
+	{
+		destruct();
+		new(data) preformatted_type(v);
+		m_type = preformatted_t;
+#ifdef TORRENT_DEBUG
+		m_type_queried = true;
+#endif
+	}
+
 	bool entry::operator==(entry const& e) const
 	{
 		if (m_type != e.m_type) return false;
@@ -450,6 +495,8 @@ namespace libtorrent
 			return list() == e.list();
 		case dictionary_t:
 			return dict() == e.dict();
+		case preformatted_t:
+			return preformatted() == e.preformatted();
 		default:
 			TORRENT_ASSERT(m_type == undefined_t);
 			return true;
@@ -472,6 +519,9 @@ namespace libtorrent
 		case dictionary_t:
 			new (data) dictionary_type;
 			break;
+		case preformatted_t:
+			new (data) preformatted_type;
+			break;
 		default:
 			TORRENT_ASSERT(t == undefined_t);
 		}
@@ -497,6 +547,9 @@ namespace libtorrent
 		case dictionary_t:
 			new (data) dictionary_type(e.dict());
 			break;
+		case preformatted_t:
+			new (data) preformatted_type(e.preformatted());
+			break;
 		default:
 			TORRENT_ASSERT(e.type() == undefined_t);
 		}
@@ -522,6 +575,9 @@ namespace libtorrent
 		case dictionary_t:
 			call_destructor(reinterpret_cast<dictionary_type*>(data));
 			break;
+		case preformatted_t:
+			call_destructor(reinterpret_cast<preformatted_type*>(data));
+			break;
 		default:
 			TORRENT_ASSERT(m_type == undefined_t);
 			break;
@@ -572,6 +628,9 @@ namespace libtorrent
 				std::swap(*reinterpret_cast<dictionary_type*>(data)
 					, *reinterpret_cast<dictionary_type*>(e.data));
 				break;
+			case preformatted_t:
+				preformatted().swap(e.preformatted());
+				break;
 			default:
 				break;
 			}
@@ -664,6 +723,9 @@ namespace libtorrent
 					i->second.to_string_impl(out, indent+2);
 				}
 			} break;
+		case preformatted_t:
+			out += "<preformatted>\n";
+			break;
 		default:
 			out += "<uninitialized>\n";
 		}
@@ -46,6 +46,7 @@ POSSIBILITY OF SUCH DAMAGE.
 #include "libtorrent/file.hpp"
 #include <cstring>
 #include <vector>
+#include <limits>
 
 #ifdef TORRENT_DEBUG_FILE_LEAKS
 #include <set>
@@ -94,6 +95,13 @@ POSSIBILITY OF SUCH DAMAGE.
 #include <errno.h>
 #include <dirent.h>
 
+#if TORRENT_HAVE_MMAP
+#include <sys/mman.h>
+#include <signal.h>
+#include <setjmp.h>
+#include <pthread.h>
+#endif
+
 #ifdef TORRENT_LINUX
 // linux specifics
 
@@ -283,6 +291,58 @@ done:
 # endif
 #endif
 
+#if TORRENT_HAVE_MMAP
+namespace
+{
+	// accessing a page of a memory mapped file that's past the end of the
+	// file (because it was truncated after it was mapped) or that the device
+	// fails to read raises SIGBUS. While a thread copies out of a mapping,
+	// this points to where it should jump back to if that happens, so the
+	// read can fail with an error instead of killing the process
+	__thread sigjmp_buf* sigbus_jmp = NULL;
+
+	// the SIGBUS handler that was installed before ours. Signals raised
+	// outside of a copy out of a mapping are passed on to it
+	struct sigaction prev_sigbus;
+
+	pthread_once_t sigbus_handler_once = PTHREAD_ONCE_INIT;
+
+	void sigbus_handler(int sig, siginfo_t* si, void* ctx)
+	{
+		sigjmp_buf* jmp = sigbus_jmp;
+		if (jmp != NULL) siglongjmp(*jmp, 1);
+
+		if (prev_sigbus.sa_flags & SA_SIGINFO)
+		{
+			prev_sigbus.sa_sigaction(sig, si, ctx);
+		}
+		else if (prev_sigbus.sa_handler != SIG_DFL
+			&& prev_sigbus.sa_handler != SIG_IGN)
+		{
+			prev_sigbus.sa_handler(sig);
+		}
+		else
+		{
+			// restore the default action. If this was a fault, returning
+			// re-executes the faulting access, which then takes the default
+			// action. If the signal was sent, re-raise it
+			signal(sig, SIG_DFL);
+			if (si == NULL || si->si_code <= 0) raise(sig);
+		}
+	}
+
+	void install_sigbus_handler()
+	{
+		struct sigaction sa;
+		memset(&sa, 0, sizeof(sa));
+		sa.sa_sigaction = &sigbus_handler;
+		sa.sa_flags = SA_SIGINFO;
+		sigemptyset(&sa.sa_mask);
+		sigaction(SIGBUS, &sa, &prev_sigbus);
+	}
+}
+#endif
+
 #ifdef TORRENT_DEBUG
 BOOST_STATIC_ASSERT((libtorrent::file::rw_mask & libtorrent::file::sparse) == 0);
 BOOST_STATIC_ASSERT((libtorrent::file::rw_mask & libtorrent::file::attribute_mask) == 0);
@@ -1241,6 +1301,10 @@ namespace libtorrent
 		, m_open_mode(0)
 #if defined TORRENT_WINDOWS || defined TORRENT_LINUX
 		, m_sector_size(0)
+#endif
+#if TORRENT_HAVE_MMAP
+		, m_mapping(NULL)
+		, m_mapping_size(0)
 #endif
 	{
 #ifdef TORRENT_DISK_STATS
@@ -1253,6 +1317,10 @@ namespace libtorrent
 		, m_open_mode(0)
 #if defined TORRENT_WINDOWS || defined TORRENT_LINUX
 		, m_sector_size(0)
+#endif
+#if TORRENT_HAVE_MMAP
+		, m_mapping(NULL)
+		, m_mapping_size(0)
 #endif
 	{
 #ifdef TORRENT_DISK_STATS
@@ -1464,6 +1532,32 @@ namespace libtorrent
 		}
 #endif
 
+#if TORRENT_HAVE_MMAP
+		if ((mode & memory_map) && (mode & rw_mask) == read_only)
+		{
+			pthread_once(&sigbus_handler_once, &install_sigbus_handler);
+
+			// if this fails, we just don't have a mapping and reads are
+			// issued as regular reads
+			struct stat st;
+			if (fstat(native_handle(), &st) == 0 && st.st_size > 0
+				&& boost::uint64_t(st.st_size) <= (std::numeric_limits<size_t>::max)())
+			{
+				void* m = mmap(NULL, size_t(st.st_size), PROT_READ, MAP_SHARED
+					, native_handle(), 0);
+				if (m != MAP_FAILED)
+				{
+#ifdef MADV_RANDOM
+					if (mode & random_access)
+						madvise(m, size_t(st.st_size), MADV_RANDOM);
+#endif
+					m_mapping = static_cast<char const*>(m);
+					m_mapping_size = st.st_size;
+				}
+			}
+		}
+#endif
+
 #endif
 		m_open_mode = mode;
 
@@ -1578,6 +1672,14 @@ typedef struct _FILE_ALLOCATED_RANGE_BUFFER {
 		CloseHandle(native_handle());
 		m_path.clear();
 #else
+#if TORRENT_HAVE_MMAP
+		if (m_mapping != NULL)
+		{
+			munmap(const_cast<char*>(m_mapping), size_t(m_mapping_size));
+			m_mapping = NULL;
+			m_mapping_size = 0;
+		}
+#endif
 		if (m_file_handle != INVALID_HANDLE_VALUE)
 			::close(m_file_handle);
 #endif
@@ -1743,6 +1845,41 @@ typedef struct _FILE_ALLOCATED_RANGE_BUFFER {
 #endif
 	}
 
+#if TORRENT_HAVE_MMAP
+	void scatter_copy_mapping(char const* src, file::iovec_t const* bufs, int num_bufs)
+	{
+		for (file::iovec_t const* i = bufs, *end(bufs + num_bufs); i < end; ++i)
+		{
+			std::memcpy(i->iov_base, src, i->iov_len);
+			src += i->iov_len;
+		}
+	}
+
+	// copies out of a memory mapped file. If the file has been truncated
+	// since it was mapped, or the device fails to read a page, the copy
+	// raises SIGBUS and the handler jumps back here, which makes this return
+	// false
+	bool copy_from_mapping(char const* src, file::iovec_t const* bufs, int num_bufs)
+	{
+		// these are live across sigsetjmp(), they must not be kept in
+		// registers
+		char const* volatile copy_src = src;
+		file::iovec_t const* volatile copy_bufs = bufs;
+		int volatile copy_num_bufs = num_bufs;
+
+		sigjmp_buf jmp;
+		if (sigsetjmp(jmp, 1) != 0)
+		{
+			sigbus_jmp = NULL;
+			return false;
+		}
+		sigbus_jmp = &jmp;
+		scatter_copy_mapping(copy_src, copy_bufs, copy_num_bufs);
+		sigbus_jmp = NULL;
+		return true;
+	}
+#endif
+
 	} // anonymous namespace
 
 	// this has to be thread safe and atomic. i.e. on posix systems it has to be
@@ -1764,6 +1901,22 @@ typedef struct _FILE_ALLOCATED_RANGE_BUFFER {
 		TORRENT_ASSERT(num_bufs > 0);
 		TORRENT_ASSERT(is_open());
 
+#if TORRENT_HAVE_MMAP
+		// if the whole range is covered by the mapping, copy straight out of
+		// it. If the file has grown since we mapped it, the tail is read the
+		// regular way
+		if (m_mapping != NULL
+			&& file_offset + bufs_size(bufs, num_bufs) <= m_mapping_size)
+		{
+			if (!copy_from_mapping(m_mapping + file_offset, bufs, num_bufs))
+			{
+				ec.assign(EIO, generic_category());
+				return -1;
+			}
+			return bufs_size(bufs, num_bufs);
+		}
+#endif
+
 #if TORRENT_USE_PREADV
 		int ret = iov(&::preadv, native_handle(), file_offset, bufs, num_bufs, ec);
 #else
@@ -1789,6 +1942,26 @@ typedef struct _FILE_ALLOCATED_RANGE_BUFFER {
 		return ret;
 	}
 
+	void file::hint_read(boost::int64_t file_offset, int len)
+	{
+		if (m_file_handle == INVALID_HANDLE_VALUE) return;
+		TORRENT_ASSERT(file_offset >= 0);
+		TORRENT_ASSERT(len > 0);
+
+#if defined F_RDADVISE
+		// for BSD/Mac
+		radvisory r;
+		r.ra_offset = file_offset;
+		r.ra_count = len;
+		fcntl(native_handle(), F_RDADVISE, &r);
+#elif defined POSIX_FADV_WILLNEED
+		posix_fadvise(native_handle(), file_offset, len, POSIX_FADV_WILLNEED);
+#else
+		TORRENT_UNUSED(file_offset);
+		TORRENT_UNUSED(len);
+#endif
+	}
+
 	// This has to be thread safe, i.e. atomic.
 	// that means, on posix this has to be turned into a series of
 	// pwrite() calls
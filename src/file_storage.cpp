@@ -34,7 +34,6 @@ POSSIBILITY OF SUCH DAMAGE.
 #include "libtorrent/string_util.hpp" // for allocate_string_copy
 #include "libtorrent/file.hpp"
 #include "libtorrent/utf8.hpp"
-#include <boost/bind.hpp>
 #include <boost/crc.hpp>
 #include <cstdio>
 #include <algorithm>
@@ -89,6 +88,9 @@ namespace libtorrent
 		m_file_base = f.m_file_base;
 #endif
 		m_paths = f.m_paths;
+		// the path index refers to the old paths. It's rebuilt from m_paths
+		// the next time a file is added
+		free_path_index();
 		m_name = f.m_name;
 		m_total_size = f.m_total_size;
 		m_num_files = f.m_num_files;
@@ -185,31 +187,58 @@ namespace libtorrent
 			e.no_root_dir = true;
 		}
 
-		// do we already have this path in the path list?
-		std::vector<std::string>::reverse_iterator p
-			= std::find_if(m_paths.rbegin(), m_paths.rend()
-				, boost::bind(&compare_string, branch_path, branch_len, _1));
+		// trim trailing slashes. This has to be done before looking up the
+		// path, since that's the form it's stored in
+		if (branch_len > 0 && branch_path[branch_len-1] == TORRENT_SEPARATOR)
+			--branch_len;
 
-		if (p == m_paths.rend())
+		e.path_index = find_or_add_path(branch_path, branch_len);
+		if (set_name) e.set_name(leaf);
+	}
+
+	int file_storage::find_or_add_path(char const* branch_path, int branch_len)
+	{
+		// the index is not copied along with the file_storage, rebuild it
+		// if it's out of date
+		if (m_path_index.size() != m_paths.size())
 		{
-			// no, we don't. add it
-			e.path_index = m_paths.size();
-			TORRENT_ASSERT(branch_path[0] != '/');
+			m_path_index.clear();
+			for (int i = 0; i < int(m_paths.size()); ++i)
+			{
+				std::string const& p = m_paths[i];
+				m_path_index.insert(std::make_pair(
+					boost::hash_range(p.begin(), p.end()), i));
+			}
+		}
 
-			// trim trailing slashes
-			if (branch_len > 0 && branch_path[branch_len-1] == TORRENT_SEPARATOR)
-				--branch_len;
+		std::size_t const hash = boost::hash_range(branch_path
+			, branch_path + branch_len);
 
-			// poor man's emplace back
-			m_paths.resize(m_paths.size() + 1);
-			m_paths.back().assign(branch_path, branch_len);
-		}
-		else
+		// do we already have this path in the path list?
+		typedef boost::unordered_multimap<std::size_t, int>::const_iterator iter;
+		std::pair<iter, iter> range = m_path_index.equal_range(hash);
+		for (; range.first != range.second; ++range.first)
 		{
 			// yes we do. use it
-			e.path_index = p.base() - m_paths.begin() - 1;
+			if (compare_string(branch_path, branch_len, m_paths[range.first->second]))
+				return range.first->second;
 		}
-		if (set_name) e.set_name(leaf);
+
+		// no, we don't. add it
+		TORRENT_ASSERT(branch_len == 0 || branch_path[0] != '/');
+		int const ret = int(m_paths.size());
+
+		// poor man's emplace back
+		m_paths.resize(m_paths.size() + 1);
+		m_paths.back().assign(branch_path, branch_len);
+		m_path_index.insert(std::make_pair(hash, ret));
+		return ret;
+	}
+
+	void file_storage::free_path_index()
+	{
+		// clear() keeps the bucket array around, swap it out to free it
+		boost::unordered_multimap<std::size_t, int>().swap(m_path_index);
 	}
 
 #ifndef TORRENT_NO_DEPRECATE
@@ -1073,6 +1102,7 @@ namespace libtorrent
 		std::vector<boost::int64_t>().swap(m_file_base);
 #endif
 		std::vector<std::string>().swap(m_paths);
+		free_path_index();
 	}
 }
 
@@ -74,17 +74,21 @@ enum { announce_interval = 30 };
 namespace {
 
 // remove peers that have timed out
-void purge_peers(std::set<peer_entry>& peers)
+void purge_peers(std::vector<peer_entry>& peers)
 {
-	for (std::set<peer_entry>::iterator i = peers.begin()
-		  , end(peers.end()); i != end;)
+	time_point const cutoff = aux::time_now()
+		- minutes(int(announce_interval * 1.5f));
+
+	std::vector<peer_entry>::iterator out = peers.begin();
+	for (std::vector<peer_entry>::iterator i = peers.begin()
+		, end(peers.end()); i != end; ++i)
 	{
 		// the peer has timed out
-		if (i->added + minutes(int(announce_interval * 1.5f)) < aux::time_now())
-			peers.erase(i++);
-		else
-			++i;
+		if (i->added < cutoff) continue;
+		if (out != i) *out = *i;
+		++out;
 	}
+	peers.erase(out, peers.end());
 }
 
 void nop() {}
@@ -576,23 +580,19 @@ time_duration node::connection_timeout()
 	}
 
 	// look through all peers and see if any have timed out
-	for (table_t::iterator i = m_map.begin(), end(m_map.end()); i != end;)
+	for (table_t::iterator i = m_map.begin(); i != m_map.end();)
 	{
 		torrent_entry& t = i->second;
-		node_id const& key = i->first;
-		++i;
 		purge_peers(t.peers);
 
 		// if there are no more peers, remove the entry altogether
-		if (t.peers.empty())
+		if (!t.peers.empty())
 		{
-			table_t::iterator i = m_map.find(key);
-			if (i != m_map.end())
-			{
-				m_map.erase(i);
-				m_counters.inc_stats_counter(counters::dht_torrents, -1);
-			}
+			++i;
+			continue;
 		}
+		i = m_map.erase(i);
+		m_counters.inc_stats_counter(counters::dht_torrents, -1);
 	}
 
 	return d;
@@ -640,9 +640,8 @@ void node::lookup_peers(sha1_hash const& info_hash, entry& reply
 	if (m_observer)
 		m_observer->get_peers(info_hash);
 
-	table_t::const_iterator i = m_map.lower_bound(info_hash);
+	table_t::const_iterator i = m_map.find(info_hash);
 	if (i == m_map.end()) return;
-	if (i->first != info_hash) return;
 
 	torrent_entry const& v = i->second;
 
@@ -653,7 +652,7 @@ void node::lookup_peers(sha1_hash const& info_hash, entry& reply
 		bloom_filter<256> downloaders;
 		bloom_filter<256> seeds;
 
-		for (std::set<peer_entry>::const_iterator i = v.peers.begin()
+		for (std::vector<peer_entry>::const_iterator i = v.peers.begin()
 			, end(v.peers.end()); i != end; ++i)
 		{
 			sha1_hash iphash;
@@ -668,7 +667,7 @@ void node::lookup_peers(sha1_hash const& info_hash, entry& reply
 	else
 	{
 		int num = (std::min)((int)v.peers.size(), m_settings.max_peers_reply);
-		std::set<peer_entry>::const_iterator iter = v.peers.begin();
+		std::vector<peer_entry>::const_iterator iter = v.peers.begin();
 		entry::list_type& pe = reply["values"].list();
 		std::string endpoint;
 
@@ -914,7 +913,7 @@ void node::incoming_request(msg const& m, entry& e)
 		m_counters.inc_stats_counter(counters::dht_get_peers_in);
 
 		sha1_hash info_hash(msg_keys[0].string_ptr());
-		nodes_t n;
+		nodes_t& n = m_nodes_scratch;
 		// always return nodes as well as peers
 		m_table.find_node(info_hash, n, 0);
 		write_nodes_entry(reply, n);
@@ -949,7 +948,7 @@ void node::incoming_request(msg const& m, entry& e)
 		sha1_hash target(msg_keys[0].string_ptr());
 
 		// TODO: 2 find_node should write directly to the response entry
-		nodes_t n;
+		nodes_t& n = m_nodes_scratch;
 		m_table.find_node(target, n, 0);
 		write_nodes_entry(reply, n);
 	}
@@ -1049,9 +1048,32 @@ void node::incoming_request(msg const& m, entry& e)
 		peer.addr = tcp::endpoint(m.addr.address(), port);
 		peer.added = aux::time_now();
 		peer.seed = msg_keys[4] && msg_keys[4].int_value();
-		std::set<peer_entry>::iterator i = v->peers.find(peer);
-		if (i != v->peers.end()) v->peers.erase(i++);
-		v->peers.insert(i, peer);
+		std::vector<peer_entry>::iterator i = std::lower_bound(
+			v->peers.begin(), v->peers.end(), peer);
+		if (i != v->peers.end() && !(peer < *i))
+		{
+			// we already have this peer, just refresh it
+			*i = peer;
+		}
+		else
+		{
+			if (!v->peers.empty()
+				&& int(v->peers.size()) >= m_settings.max_peers)
+			{
+				// we're at the limit of peers to store for this torrent.
+				// make room by evicting the one we heard from the longest
+				// time ago
+				std::vector<peer_entry>::iterator oldest = v->peers.begin();
+				for (std::vector<peer_entry>::iterator j = v->peers.begin()
+					, end(v->peers.end()); j != end; ++j)
+				{
+					if (j->added < oldest->added) oldest = j;
+				}
+				if (oldest < i) --i;
+				v->peers.erase(oldest);
+			}
+			v->peers.insert(i, peer);
+		}
 	}
 	else if (query_len == 3 && memcmp(query, "put", 3) == 0)
 	{
@@ -1309,7 +1331,7 @@ void node::incoming_request(msg const& m, entry& e)
 
 		reply["token"] = generate_token(m.addr, msg_keys[1].string_ptr());
 		
-		nodes_t n;
+		nodes_t& n = m_nodes_scratch;
 		// always return nodes as well as peers
 		m_table.find_node(target, n, 0);
 		write_nodes_entry(reply, n);
@@ -1359,7 +1381,7 @@ void node::incoming_request(msg const& m, entry& e)
 		}
 
 		sha1_hash target(target_ent.string_ptr());
-		nodes_t n;
+		nodes_t& n = m_nodes_scratch;
 		// always return nodes as well as peers
 		m_table.find_node(target, n, 0);
 		write_nodes_entry(reply, n);
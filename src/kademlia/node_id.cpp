@@ -49,28 +49,14 @@ namespace libtorrent { namespace dht
 // using the kademlia XOR-metric
 node_id distance(node_id const& n1, node_id const& n2)
 {
-	node_id ret;
-	node_id::iterator k = ret.begin();
-	for (node_id::const_iterator i = n1.begin(), j = n2.begin()
-		, end(n1.end()); i != end; ++i, ++j, ++k)
-	{
-		*k = *i ^ *j;
-	}
-	return ret;
+	return n1 ^ n2;
 }
 
 // returns true if: distance(n1, ref) < distance(n2, ref)
 bool compare_ref(node_id const& n1, node_id const& n2, node_id const& ref)
 {
-	for (node_id::const_iterator i = n1.begin(), j = n2.begin()
-		, k = ref.begin(), end(n1.end()); i != end; ++i, ++j, ++k)
-	{
-		boost::uint8_t lhs = (*i ^ *k);
-		boost::uint8_t rhs = (*j ^ *k);
-		if (lhs < rhs) return true;
-		if (lhs > rhs) return false;
-	}
-	return false;
+	// sha1_hash XORs and compares 32 bits at a time
+	return (n1 ^ ref) < (n2 ^ ref);
 }
 
 // returns n in: 2^n <= distance(n1, n2) < 2^(n+1)
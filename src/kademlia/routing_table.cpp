@@ -1150,8 +1150,10 @@ void routing_table::find_node(node_id const& target
 
 		if (int(l.size()) > count)
 		{
-			// sort the nodes by how close they are to the target
-			std::sort(l.begin() + unsorted_start_idx, l.end(), boost::bind(&compare_ref
+			// keep the nodes closest to the target. The ones we return don't
+			// need to be ordered, so a selection is enough
+			std::nth_element(l.begin() + unsorted_start_idx, l.begin() + count
+				, l.end(), boost::bind(&compare_ref
 				, boost::bind(&node_entry::id, _1)
 				, boost::bind(&node_entry::id, _2), target));
 
@@ -1189,8 +1191,10 @@ void routing_table::find_node(node_id const& target
 
 		if (int(l.size()) > count)
 		{
-			// sort the nodes by how close they are to the target
-			std::sort(l.begin() + unsorted_start_idx, l.end(), boost::bind(&compare_ref
+			// keep the nodes closest to the target. The ones we return don't
+			// need to be ordered, so a selection is enough
+			std::nth_element(l.begin() + unsorted_start_idx, l.begin() + count
+				, l.end(), boost::bind(&compare_ref
 				, boost::bind(&node_entry::id, _1)
 				, boost::bind(&node_entry::id, _2), target));
 
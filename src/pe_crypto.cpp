@@ -355,33 +355,24 @@ namespace libtorrent
 
 void rc4_init(const unsigned char* in, unsigned long len, rc4 *state)
 {
-	unsigned char key[256], tmp, *s;
-	int keylen, x, y, j;
-
 	TORRENT_ASSERT(state != 0);
+	TORRENT_ASSERT(len > 0);
 	TORRENT_ASSERT(len <= 256);
 
-	state->x = 0;
-	while (len--) {
-		state->buf[state->x++] = *in++;
-	}
-
-	/* extract the key */
-	s = state->buf;
-	memcpy(key, s, 256);
-	keylen = state->x;
+	unsigned int* s = state->buf;
 
 	/* make RC4 perm and shuffle */
-	for (x = 0; x < 256; x++) {
+	for (unsigned int x = 0; x < 256; x++) {
 		s[x] = x;
 	}
 
-	for (j = x = y = 0; x < 256; x++) {
-		y = (y + state->buf[x] + key[j++]) & 255;
-		if (j == keylen) {
-			j = 0; 
+	unsigned int y = 0;
+	for (unsigned int x = 0, j = 0; x < 256; x++) {
+		y = (y + s[x] + in[j++]) & 255;
+		if (j == len) {
+			j = 0;
 		}
-		tmp = s[x]; s[x] = s[y]; s[y] = tmp;
+		unsigned int const tmp = s[x]; s[x] = s[y]; s[y] = tmp;
 	}
 	state->x = 0;
 	state->y = 0;
@@ -389,26 +380,25 @@ void rc4_init(const unsigned char* in, unsigned long len, rc4 *state)
 
 unsigned long rc4_encrypt(unsigned char *out, unsigned long outlen, rc4 *state)
 {
-	unsigned char x, y, *s, tmp;
-	unsigned long n;
-
 	TORRENT_ASSERT(out != 0);
 	TORRENT_ASSERT(state != 0);
 
-	n = outlen;
-	x = state->x;
-	y = state->y;
-	s = state->buf;
-	while (outlen--) {
+	unsigned int x = state->x;
+	unsigned int y = state->y;
+	unsigned int* const s = state->buf;
+
+	for (unsigned long n = outlen; n > 0; --n) {
 		x = (x + 1) & 255;
-		y = (y + s[x]) & 255;
-		tmp = s[x]; s[x] = s[y]; s[y] = tmp;
-		tmp = (s[x] + s[y]) & 255;
-		*out++ ^= s[tmp];
+		unsigned int const tx = s[x];
+		y = (y + tx) & 255;
+		unsigned int const ty = s[y];
+		s[x] = ty;
+		s[y] = tx;
+		*out++ ^= (unsigned char)s[(tx + ty) & 255];
 	}
 	state->x = x;
 	state->y = y;
-	return n;
+	return outlen;
 }
 
 #endif // #if !defined(TORRENT_DISABLE_ENCRYPTION) && !defined(TORRENT_DISABLE_EXTENSIONS)
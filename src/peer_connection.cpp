@@ -84,6 +84,13 @@ POSSIBILITY OF SUCH DAMAGE.
 #include "libtorrent/close_reason.hpp"
 #include "libtorrent/aux_/time.hpp"
 
+#if TORRENT_USE_SENDFILE
+#include <sys/sendfile.h>
+#include <signal.h>
+#include <pthread.h>
+#include <errno.h>
+#endif
+
 //#define TORRENT_CORRUPT_DATA
 
 using boost::shared_ptr;
@@ -104,6 +111,39 @@ namespace libtorrent
 		return pb.send_buffer_offset != pending_block::not_in_buffer;
 	}
 
+#if TORRENT_USE_SENDFILE
+	// sendfile() can't be passed MSG_NOSIGNAL. Writing to a socket the
+	// peer has closed would raise SIGPIPE and kill the process, unless the
+	// client ignores it. Block the signal on this thread for the duration
+	// of the call and discard it if it was raised by us
+	ssize_t sendfile_nosignal(int sock, int fd, off_t* offset, int amount)
+	{
+		sigset_t pipe_mask;
+		sigemptyset(&pipe_mask);
+		sigaddset(&pipe_mask, SIGPIPE);
+
+		sigset_t pending;
+		sigpending(&pending);
+		bool const pipe_pending = sigismember(&pending, SIGPIPE);
+
+		sigset_t old_mask;
+		pthread_sigmask(SIG_BLOCK, &pipe_mask, &old_mask);
+
+		ssize_t const ret = ::sendfile(sock, fd, offset, amount);
+		int const err = errno;
+
+		if (ret < 0 && err == EPIPE && !pipe_pending)
+		{
+			timespec const zero = { 0, 0 };
+			sigtimedwait(&pipe_mask, NULL, &zero);
+		}
+
+		pthread_sigmask(SIG_SETMASK, &old_mask, NULL);
+		errno = err;
+		return ret;
+	}
+#endif
+
 	}
 
 #if TORRENT_USE_ASSERTS
@@ -125,6 +165,7 @@ namespace libtorrent
 		, m_recv_buffer(*pack.allocator)
 		, m_max_out_request_queue(m_settings.get_int(settings_pack::max_out_request_queue))
 		, m_remote(pack.endp)
+		, m_send_file_bytes(0)
 		, m_disk_thread(*pack.disk_thread)
 		, m_allocator(*pack.allocator)
 		, m_ios(*pack.ios)
@@ -162,6 +203,7 @@ namespace libtorrent
 		, m_desired_queue_size(2)
 		, m_prefer_contiguous_blocks(0)
 		, m_disk_read_failures(0)
+		, m_network_thread(-1)
 		, m_outstanding_piece_verification(0)
 		, m_outgoing(!pack.tor.expired())
 		, m_received_listen_port(false)
@@ -3803,7 +3845,7 @@ namespace libtorrent
 				m_counters.inc_stats_counter(counters::num_peers_down_requests);
 
 			TORRENT_ASSERT(verify_piece(t->to_req(block.block)));
-			block.send_buffer_offset = m_send_buffer.size();
+			block.send_buffer_offset = send_buffer_size();
 			m_download_queue.push_back(block);
 			m_outstanding_bytes += block_size;
 #if TORRENT_USE_INVARIANT_CHECKS
@@ -3831,7 +3873,7 @@ namespace libtorrent
 					if (m_download_queue.empty())
 						m_counters.inc_stats_counter(counters::num_peers_down_requests);
 
-					block.send_buffer_offset = m_send_buffer.size();
+					block.send_buffer_offset = send_buffer_size();
 					m_download_queue.push_back(block);
 					if (m_queued_time_critical) --m_queued_time_critical;
 
@@ -4011,6 +4053,8 @@ namespace libtorrent
 			// make sure we free up all send buffers that are owned
 			// by the disk thread
 			m_send_buffer.clear();
+			m_send_file_regions.clear();
+			m_send_file_bytes = 0;
 			m_recv_buffer.free_disk_buffer();
 		}
 
@@ -5081,10 +5125,20 @@ namespace libtorrent
 
 				// the callback function may be called immediately, instead of being posted
 				if (!t->need_loaded()) return;
-				t->inc_refcount("async_read");
-				m_disk_thread.async_read(&t->storage(), r
-					, boost::bind(&peer_connection::on_disk_read_complete
-					, self(), _1, r, clock_type::now()), this);
+				if (supports_sendfile())
+				{
+					t->inc_refcount("async_sendfile");
+					m_disk_thread.async_prepare_sendfile(&t->storage(), r
+						, boost::bind(&peer_connection::on_sendfile_prepared
+						, self(), _1, r), this);
+				}
+				else
+				{
+					t->inc_refcount("async_read");
+					m_disk_thread.async_read(&t->storage(), r
+						, boost::bind(&peer_connection::on_disk_read_complete
+						, self(), _1, r, clock_type::now()), this);
+				}
 			}
 			m_requests.erase(m_requests.begin() + i);
 
@@ -5249,6 +5303,51 @@ namespace libtorrent
 		write_piece(r, buffer);
 	}
 
+	void peer_connection::on_sendfile_prepared(disk_io_job const* j
+		, peer_request r)
+	{
+		TORRENT_ASSERT(is_single_thread());
+
+		m_reading_bytes -= r.length;
+
+		boost::shared_ptr<torrent> t = m_torrent.lock();
+		torrent_ref_holder h(t.get(), "async_sendfile");
+		if (t) t->dec_refcount("async_sendfile");
+
+		if (m_disconnecting) return;
+
+		if (!t)
+		{
+			disconnect(j->error.ec, op_file_read);
+			return;
+		}
+
+		std::vector<open_file_slice> const& slices = *j->buffer.file_slices;
+		if (slices.empty())
+		{
+			// the block is in the cache, or it can't be sent straight from the
+			// files it's stored in. Read it the regular way instead
+#ifndef TORRENT_DISABLE_LOGGING
+			peer_log(peer_log_alert::info, "FILE_ASYNC_READ"
+				, "piece: %d s: %x l: %x (no sendfile)", r.piece, r.start, r.length);
+#endif
+			if (!t->need_loaded()) return;
+			m_reading_bytes += r.length;
+			t->inc_refcount("async_read");
+			m_disk_thread.async_read(&t->storage(), r
+				, boost::bind(&peer_connection::on_disk_read_complete
+				, self(), _1, r, clock_type::now()), this);
+			return;
+		}
+
+#ifndef TORRENT_DISABLE_LOGGING
+		peer_log(peer_log_alert::outgoing_message, "PIECE"
+			, "piece: %d s: %x l: %x files: %d (sendfile)", r.piece, r.start, r.length
+			, int(slices.size()));
+#endif
+		write_file_piece(r, slices);
+	}
+
 	void peer_connection::assign_bandwidth(int channel, int amount)
 	{
 		TORRENT_ASSERT(is_single_thread());
@@ -5298,7 +5397,7 @@ namespace libtorrent
 		else
 		{
 			return (std::max)((std::max)(m_reading_bytes
-				, m_send_buffer.size())
+				, send_buffer_size())
 				, int((boost::int64_t(m_statistics.upload_rate()) * 2
 					* tick_interval) / 1000));
 		}
@@ -5418,7 +5517,7 @@ namespace libtorrent
 		}
 
 		if ((m_quota[upload_channel] == 0 || m_send_barrier == 0)
-			&& !m_send_buffer.empty()
+			&& send_buffer_size() > 0
 			&& !m_connecting)
 		{
 			return;
@@ -5426,7 +5525,7 @@ namespace libtorrent
 
 		int quota_left = m_quota[upload_channel];
 
-		if (m_send_buffer.empty()
+		if (send_buffer_size() == 0
 			&& m_reading_bytes > 0
 			&& quota_left > 0)
 		{
@@ -5471,12 +5570,12 @@ namespace libtorrent
 		if (!can_write())
 		{
 #ifndef TORRENT_DISABLE_LOGGING
-			if (m_send_buffer.empty())
+			if (send_buffer_size() == 0)
 			{
 				peer_log(peer_log_alert::outgoing, "SEND_BUFFER_DEPLETED"
 					, "quota: %d buf: %d connecting: %s disconnecting: %s pending_disk: %d"
 					, m_quota[upload_channel]
-					, int(m_send_buffer.size()), m_connecting?"yes":"no"
+					, send_buffer_size(), m_connecting?"yes":"no"
 					, m_disconnecting?"yes":"no", m_reading_bytes);
 			}
 			else
@@ -5484,15 +5583,23 @@ namespace libtorrent
 				peer_log(peer_log_alert::outgoing, "CANNOT_WRITE"
 					, "quota: %d buf: %d connecting: %s disconnecting: %s pending_disk: %d"
 					, m_quota[upload_channel]
-					, int(m_send_buffer.size()), m_connecting?"yes":"no"
+					, send_buffer_size(), m_connecting?"yes":"no"
 					, m_disconnecting?"yes":"no", m_reading_bytes);
 			}
 #endif
 			return;
 		}
 
-		// send the actual buffer
+		// send the actual buffer. A single write either sends from
+		// m_send_buffer, up to the first file region, or from the first file
+		// region
+		bool const send_file = !m_send_file_regions.empty()
+			&& m_send_file_regions.front().send_buffer_offset == 0;
 		int amount_to_send = m_send_buffer.size();
+		if (send_file)
+			amount_to_send = m_send_file_regions.front().size;
+		else if (!m_send_file_regions.empty())
+			amount_to_send = m_send_file_regions.front().send_buffer_offset;
 		if (amount_to_send > quota_left)
 			amount_to_send = quota_left;
 		if (amount_to_send > m_send_barrier)
@@ -5510,6 +5617,29 @@ namespace libtorrent
 		}
 
 		TORRENT_ASSERT((m_channel_state[upload_channel] & peer_info::bw_network) == 0);
+
+		if (send_file)
+		{
+#ifndef TORRENT_DISABLE_LOGGING
+			peer_log(peer_log_alert::outgoing, "ASYNC_SENDFILE", "bytes: %d", amount_to_send);
+#endif
+#if defined TORRENT_ASIO_DEBUGGING
+			add_outstanding_async("peer_connection::on_send_data");
+#endif
+#if TORRENT_USE_ASSERTS
+			TORRENT_ASSERT(!m_socket_is_writing);
+			m_socket_is_writing = true;
+#endif
+			// wait for the socket to become writable, the data is sent by
+			// on_sendfile_writable()
+			TORRENT_ASSERT(m_socket->get<tcp::socket>());
+			m_socket->get<tcp::socket>()->async_write_some(asio::null_buffers()
+				, make_write_handler(boost::bind(&peer_connection::on_sendfile_writable
+				, self(), _1, amount_to_send)));
+			m_channel_state[upload_channel] |= peer_info::bw_network;
+			return;
+		}
+
 #ifndef TORRENT_DISABLE_LOGGING
 		peer_log(peer_log_alert::outgoing, "ASYNC_WRITE", "bytes: %d", amount_to_send);
 #endif
@@ -5761,6 +5891,20 @@ namespace libtorrent
 			, userdata, ref);
 	}
 
+	void peer_connection::append_send_file(open_file_slice const& s)
+	{
+		TORRENT_ASSERT(is_single_thread());
+		TORRENT_ASSERT(s.size > 0);
+
+		send_file_region r;
+		r.file = s.file;
+		r.offset = s.offset;
+		r.size = s.size;
+		r.send_buffer_offset = m_send_buffer.size();
+		m_send_file_regions.push_back(r);
+		m_send_file_bytes += s.size;
+	}
+
 	boost::optional<piece_block_progress>
 	peer_connection::downloading_piece_progress() const
 	{
@@ -6120,7 +6264,7 @@ namespace libtorrent
 		TORRENT_ASSERT(is_single_thread());
 		// if we have requests or pending data to be sent or announcements to be made
 		// we want to send data
-		return !m_send_buffer.empty()
+		return send_buffer_size() > 0
 			&& m_quota[upload_channel] > 0
 			&& (m_send_barrier > 0)
 			&& !m_connecting;
@@ -6355,7 +6499,28 @@ namespace libtorrent
 
 		TORRENT_ASSERT(m_channel_state[upload_channel] & peer_info::bw_network);
 
-		m_send_buffer.pop_front(bytes_transferred);
+		if (!m_send_file_regions.empty()
+			&& m_send_file_regions.front().send_buffer_offset == 0)
+		{
+			// this was a sendfile() from the first file region
+			send_file_region& fr = m_send_file_regions.front();
+			TORRENT_ASSERT(int(bytes_transferred) <= fr.size);
+			fr.offset += bytes_transferred;
+			fr.size -= bytes_transferred;
+			m_send_file_bytes -= bytes_transferred;
+			if (fr.size == 0) m_send_file_regions.pop_front();
+		}
+		else
+		{
+			m_send_buffer.pop_front(bytes_transferred);
+
+			for (std::deque<send_file_region>::iterator i = m_send_file_regions.begin()
+				, end(m_send_file_regions.end()); i != end; ++i)
+			{
+				TORRENT_ASSERT(i->send_buffer_offset >= int(bytes_transferred));
+				i->send_buffer_offset -= bytes_transferred;
+			}
+		}
 
 		time_point now = clock_type::now();
 
@@ -6400,6 +6565,8 @@ namespace libtorrent
 			// make sure we free up all send buffers that are owned
 			// by the disk thread
 			m_send_buffer.clear();
+			m_send_file_regions.clear();
+			m_send_file_bytes = 0;
 			m_recv_buffer.free_disk_buffer();
 			return;
 		}
@@ -6427,6 +6594,70 @@ namespace libtorrent
 		setup_send();
 	}
 
+	void peer_connection::on_sendfile_writable(error_code const& error
+		, int amount)
+	{
+		TORRENT_ASSERT(is_single_thread());
+
+		if (error || m_disconnecting)
+		{
+			on_send_data(error, 0);
+			return;
+		}
+
+#if TORRENT_USE_SENDFILE
+		TORRENT_ASSERT(!m_send_file_regions.empty());
+		send_file_region const& fr = m_send_file_regions.front();
+		TORRENT_ASSERT(fr.send_buffer_offset == 0);
+		TORRENT_ASSERT(amount <= fr.size);
+
+		tcp::socket* s = m_socket->get<tcp::socket>();
+		TORRENT_ASSERT(s);
+
+		// the socket has to be non-blocking for sendfile() to return
+		// rather than wait for more room in the socket buffer
+		error_code ec;
+		if (!s->native_non_blocking())
+			s->native_non_blocking(true, ec);
+		if (ec)
+		{
+			on_send_data(ec, 0);
+			return;
+		}
+
+		off_t offset = fr.offset;
+		ssize_t ret = sendfile_nosignal(s->native_handle()
+			, fr.file->native_handle(), &offset, amount);
+		if (ret < 0)
+		{
+			if (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR)
+			{
+				// the socket buffer filled up again. Wait for it to become
+				// writable again
+				s->async_write_some(asio::null_buffers()
+					, make_write_handler(boost::bind(&peer_connection::on_sendfile_writable
+					, self(), _1, amount)));
+				return;
+			}
+			on_send_data(error_code(errno, system_category()), 0);
+			return;
+		}
+
+		// the file is shorter than it's supposed to be
+		if (ret == 0)
+		{
+			on_send_data(errors::file_too_short, 0);
+			return;
+		}
+
+		on_send_data(error, ret);
+#else
+		TORRENT_UNUSED(amount);
+		TORRENT_ASSERT(false);
+		on_send_data(boost::asio::error::operation_not_supported, 0);
+#endif
+	}
+
 #if TORRENT_USE_INVARIANT_CHECKS
 	struct peer_count_t
 	{
@@ -124,6 +124,8 @@ namespace libtorrent
 		, m_num_seeds(0)
 		, m_finished(0)
 		, m_round_robin(0)
+		, m_fruitless_scan(0)
+		, m_next_reconnect(0)
 		, m_num_connect_candidates(0)
 		, m_max_failcount(3)
 	{
@@ -485,6 +487,22 @@ namespace libtorrent
 		if (m_finished != state->is_finished)
 			recalculate_connect_candidates(state);
 
+		// if we've been through every peer without finding a single one we
+		// could connect to, they are all waiting for their reconnect timeout.
+		// Don't scan them again until the first one expires, or a new connect
+		// candidate shows up. A wait longer than any reconnect timeout means
+		// the session time has been stepped back, in which case just scan
+		if (m_fruitless_scan >= int(m_peers.size()))
+		{
+			if (session_time < m_next_reconnect
+				&& m_next_reconnect - session_time
+					<= m_max_failcount * state->min_reconnect_time)
+				return;
+			m_fruitless_scan = 0;
+		}
+		if (m_fruitless_scan == 0)
+			m_next_reconnect = (std::numeric_limits<int>::max)();
+
 		external_ip const& external = *state->ip;
 		int external_port = state->port;
 
@@ -531,12 +549,25 @@ namespace libtorrent
 
 			++m_round_robin;
 
-			if (!is_connect_candidate(pe)) continue;
+			if (!is_connect_candidate(pe))
+			{
+				++m_fruitless_scan;
+				continue;
+			}
 
 			if (pe.last_connected
 				&& session_time - pe.last_connected <
 				(int(pe.failcount) + 1) * state->min_reconnect_time)
+			{
+				m_next_reconnect = (std::min)(m_next_reconnect
+					, int(pe.last_connected)
+					+ (int(pe.failcount) + 1) * state->min_reconnect_time);
+				++m_fruitless_scan;
 				continue;
+			}
+
+			m_fruitless_scan = 0;
+			m_next_reconnect = (std::numeric_limits<int>::max)();
 
 			// compare peer returns true if lhs is better than rhs. In this
 			// case, it returns true if the current candidate is better than
@@ -1001,6 +1032,9 @@ namespace libtorrent
 		TORRENT_ASSERT(is_single_thread());
 		if (delta == 0) return;
 		m_num_connect_candidates += delta;
+		// a new candidate may be connectable right away, make sure the next
+		// call to find_connect_candidates() looks for it
+		if (delta > 0) m_fruitless_scan = 0;
 		if (delta < 0)
 		{
 			TORRENT_ASSERT(m_num_connect_candidates >= 0);
@@ -1260,6 +1294,7 @@ namespace libtorrent
 		TORRENT_ASSERT(is_single_thread());
 
 		m_num_connect_candidates = 0;
+		m_fruitless_scan = 0;
 		m_finished = state->is_finished;
 		m_max_failcount = state->max_failcount;
 
@@ -1295,6 +1295,57 @@ namespace libtorrent
 		if (prev_priority >= 0) update(prev_priority, p.index);
 	}
 
+	namespace {
+
+	// iterates over the indices of the bits that are set in a bitfield.
+	// Words and bytes with no bits set are skipped as a whole. Bitfields of
+	// peers that just joined the swarm are sparse, and on torrents with
+	// many pieces testing them one bit at a time dominates the refcounting
+	struct set_bits_iterator
+	{
+		explicit set_bits_iterator(bitfield const& bits)
+			: m_bytes(reinterpret_cast<unsigned char const*>(bits.data()))
+			, m_size(bits.size())
+			, m_index(-1)
+		{ next(); }
+
+		bool done() const { return m_index >= m_size; }
+		int index() const { return m_index; }
+
+		void next()
+		{
+			++m_index;
+			while (m_index < m_size)
+			{
+				// the bitfield buffer is an array of 32 bit words, so aligned
+				// word loads are fine. The bits past the end of the bitfield
+				// are always cleared
+				if ((m_index & 31) == 0 && *reinterpret_cast<boost::uint32_t const*>(
+					m_bytes + m_index / 8) == 0)
+				{
+					m_index += 32;
+					continue;
+				}
+				unsigned char const b = m_bytes[m_index / 8];
+				if ((m_index & 7) == 0 && b == 0)
+				{
+					m_index += 8;
+					continue;
+				}
+				if (b & (0x80 >> (m_index & 7))) return;
+				++m_index;
+			}
+			m_index = m_size;
+		}
+
+	private:
+		unsigned char const* m_bytes;
+		int m_size;
+		int m_index;
+	};
+
+	} // anonymous namespace
+
 	void piece_picker::inc_refcount(bitfield const& bitmask, const void* peer)
 	{
 #ifdef TORRENT_EXPENSIVE_INVARIANT_CHECKS
@@ -1330,12 +1381,9 @@ namespace libtorrent
 			// and mark the picker as dirty, so we'll rebuild it next time we need it.
 			// this only matters if we're not already dirty, in which case the fasted
 			// thing to do is to just update the counters and be done
-			int index = 0;
-			for (bitfield::const_iterator i = bitmask.begin()
-				, end(bitmask.end()); i != end; ++i, ++index)
+			for (set_bits_iterator i(bitmask); !i.done(); i.next())
 			{
-				if (!*i) continue;
-				if (num_inc < size) incremented[num_inc] = index;
+				if (num_inc < size) incremented[num_inc] = i.index();
 				++num_inc;
 				if (num_inc >= size) break;
 			}
@@ -1366,23 +1414,19 @@ namespace libtorrent
 			}
 		}
 
-		int index = 0;
 		bool updated = false;
-		for (bitfield::const_iterator i = bitmask.begin()
-			, end(bitmask.end()); i != end; ++i, ++index)
+		for (set_bits_iterator i(bitmask); !i.done(); i.next())
 		{
-			if (*i)
-			{
+			int const index = i.index();
 #ifdef TORRENT_DEBUG_REFCOUNTS
-				TORRENT_ASSERT(m_piece_map[index].have_peers.count(peer) == 0);
-				m_piece_map[index].have_peers.insert(peer);
+			TORRENT_ASSERT(m_piece_map[index].have_peers.count(peer) == 0);
+			m_piece_map[index].have_peers.insert(peer);
 #else
-				TORRENT_UNUSED(peer);
+			TORRENT_UNUSED(peer);
 #endif
 
-				++m_piece_map[index].peer_count;
-				updated = true;
-			}
+			++m_piece_map[index].peer_count;
+			updated = true;
 		}
 
 		// if we're already dirty, no point in doing anything more
@@ -1427,12 +1471,9 @@ namespace libtorrent
 			// and mark the picker as dirty, so we'll rebuild it next time we need it.
 			// this only matters if we're not already dirty, in which case the fasted
 			// thing to do is to just update the counters and be done
-			int index = 0;
-			for (bitfield::const_iterator i = bitmask.begin()
-				, end(bitmask.end()); i != end; ++i, ++index)
+			for (set_bits_iterator i(bitmask); !i.done(); i.next())
 			{
-				if (!*i) continue;
-				if (num_dec < size) decremented[num_dec] = index;
+				if (num_dec < size) decremented[num_dec] = i.index();
 				++num_dec;
 				if (num_dec >= size) break;
 			}
@@ -1472,35 +1513,30 @@ namespace libtorrent
 			}
 		}
 
-		int index = 0;
 		bool updated = false;
-		for (bitfield::const_iterator i = bitmask.begin()
-			, end(bitmask.end()); i != end; ++i, ++index)
+		for (set_bits_iterator i(bitmask); !i.done(); i.next())
 		{
-			if (*i)
+			piece_pos& p = m_piece_map[i.index()];
+			if (p.peer_count == 0)
 			{
-				piece_pos& p = m_piece_map[index];
-				if (p.peer_count == 0)
-				{
-					TORRENT_ASSERT(m_seeds > 0);
-					// this is the case where we have one or more
-					// seeds, and one of them saying: I don't have this
-					// piece anymore. we need to break up one of the seed
-					// counters into actual peer counters on the pieces
-					break_one_seed();
-				}
+				TORRENT_ASSERT(m_seeds > 0);
+				// this is the case where we have one or more
+				// seeds, and one of them saying: I don't have this
+				// piece anymore. we need to break up one of the seed
+				// counters into actual peer counters on the pieces
+				break_one_seed();
+			}
 
 #ifdef TORRENT_DEBUG_REFCOUNTS
-				TORRENT_ASSERT(p.have_peers.count(peer) == 1);
-				p.have_peers.erase(peer);
+			TORRENT_ASSERT(p.have_peers.count(peer) == 1);
+			p.have_peers.erase(peer);
 #else
-				TORRENT_UNUSED(peer);
+			TORRENT_UNUSED(peer);
 #endif
 
-				TORRENT_ASSERT(p.peer_count > 0);
-				--p.peer_count;
-				updated = true;
-			}
+			TORRENT_ASSERT(p.peer_count > 0);
+			--p.peer_count;
+			updated = true;
 		}
 
 		// if we're already dirty, no point in doing anything more
@@ -2020,8 +2056,10 @@ namespace libtorrent
 
 		// this will be filled with blocks that we should not request
 		// unless we can't find num_blocks among the other ones.
-		std::vector<piece_block> backup_blocks;
-		std::vector<piece_block> backup_blocks2;
+		std::vector<piece_block>& backup_blocks = m_backup_blocks;
+		std::vector<piece_block>& backup_blocks2 = m_backup_blocks2;
+		backup_blocks.clear();
+		backup_blocks2.clear();
 		const std::vector<int> empty_vector;
 	
 		// When prefer_contiguous_blocks is set (usually set when downloading from
@@ -2337,7 +2375,10 @@ get_out:
 		// m_downloads[0] and m_download[1]
 		// (i.e. partial and full pieces)
 
-		std::vector<piece_block> temp;
+		// both backup lists have been drained into interesting_blocks by now,
+		// reuse the first one as scratch space
+		std::vector<piece_block>& temp = backup_blocks;
+		TORRENT_ASSERT(temp.empty());
 
 		// pick one random block from one random partial piece.
 		// only pick from non-downloaded blocks.
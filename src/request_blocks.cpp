@@ -101,8 +101,13 @@ namespace libtorrent
 		t.need_picker();
 
 		piece_picker& p = t.picker();
-		std::vector<piece_block> interesting_pieces;
-		interesting_pieces.reserve(100);
+		aux::session_interface& ses = t.session();
+
+		// the picked blocks are collected in a vector owned by the session,
+		// to reuse its storage. Nothing in here calls back into
+		// request_a_block()
+		std::vector<piece_block>& interesting_pieces = ses.picked_blocks_storage();
+		interesting_pieces.clear();
 
 		int prefer_contiguous_blocks = c.prefer_contiguous_blocks();
 
@@ -123,8 +128,6 @@ namespace libtorrent
 		TORRENT_ASSERT(c.remote() == c.get_socket()->remote_endpoint(ec) || ec);
 #endif
 
-		aux::session_interface& ses = t.session();
-
 		std::vector<pending_block> const& dq = c.download_queue();
 		std::vector<pending_block> const& rq = c.request_queue();
 
@@ -155,10 +158,14 @@ namespace libtorrent
 		// the last argument is if we should prefer whole pieces
 		// for this peer. If we're downloading one piece in 20 seconds
 		// then use this mode.
+		time_point const start_pick = clock_type::now();
 		p.pick_pieces(*bits, interesting_pieces
 			, num_requests, prefer_contiguous_blocks, c.peer_info_struct()
 			, c.picker_options(), suggested, t.num_peers()
 			, ses.stats_counters());
+		ses.stats_counters().inc_stats_counter(counters::piece_picker_calls);
+		ses.stats_counters().inc_stats_counter(counters::piece_picker_time
+			, total_microseconds(clock_type::now() - start_pick));
 
 #ifndef TORRENT_DISABLE_LOGGING
 		c.peer_log(peer_log_alert::info, "PIECE_PICKER"
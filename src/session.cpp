@@ -610,6 +610,11 @@ namespace libtorrent
 		TORRENT_ASYNC_CALL(post_session_stats);
 	}
 
+	void session::post_session_stats_delta()
+	{
+		TORRENT_ASYNC_CALL(post_session_stats_delta);
+	}
+
 	void session::post_dht_stats()
 	{
 		TORRENT_ASYNC_CALL(post_dht_stats);
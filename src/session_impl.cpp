@@ -38,6 +38,7 @@ POSSIBILITY OF SUCH DAMAGE.
 #include <algorithm>
 #include <cctype>
 #include <algorithm>
+#include <utility> // for std::move
 
 #if defined TORRENT_DEBUG && !defined TORRENT_DISABLE_INVARIANT_CHECKS
 #if TORRENT_HAS_BOOST_UNORDERED
@@ -352,6 +353,7 @@ namespace aux {
 #endif
 		, m_disk_thread(m_io_service, m_stats_counters
 			, (uncork_interface*)this)
+		, m_next_network_thread(0)
 		, m_download_rate(peer_connection::download_channel)
 #ifdef TORRENT_VERBOSE_BANDWIDTH_LIMIT
 		, m_upload_rate(peer_connection::upload_channel, true)
@@ -696,6 +698,7 @@ namespace aux {
 			dht_sett["max_fail_count"] = m_dht_settings.max_fail_count;
 			dht_sett["max_torrents"] = m_dht_settings.max_torrents;
 			dht_sett["max_dht_items"] = m_dht_settings.max_dht_items;
+			dht_sett["max_peers"] = m_dht_settings.max_peers;
 			dht_sett["max_torrent_search_reply"] = m_dht_settings.max_torrent_search_reply;
 			dht_sett["restrict_routing_ips"] = m_dht_settings.restrict_routing_ips;
 			dht_sett["extended_routing_table"] = m_dht_settings.extended_routing_table;
@@ -759,6 +762,8 @@ namespace aux {
 			if (val) m_dht_settings.max_torrents = val.int_value();
 			val = settings.dict_find_int("max_dht_items");
 			if (val) m_dht_settings.max_dht_items = val.int_value();
+			val = settings.dict_find_int("max_peers");
+			if (val) m_dht_settings.max_peers = val.int_value();
 			val = settings.dict_find_int("max_torrent_search_reply");
 			if (val) m_dht_settings.max_torrent_search_reply = val.int_value();
 			val = settings.dict_find_int("restrict_routing_ips");
@@ -4256,17 +4261,18 @@ retry:
 		m_posting_torrent_updates = true;
 #endif
 
+		// only post the first n torrents. The rest stay at the front of the
+		// list, and since torrents are always pushed back onto it, every
+		// torrent is round-robined through the updates
+		int num_updates = int(state_updates.size());
+		int const limit = m_settings.get_int(settings_pack::max_state_updates);
+		if (limit > 0 && limit < num_updates) num_updates = limit;
+
 		std::vector<torrent_status> status;
-		status.reserve(state_updates.size());
-
-		// TODO: it might be a nice feature here to limit the number of torrents
-		// to send in a single update. By just posting the first n torrents, they
-		// would nicely be round-robined because the torrent lists are always
-		// pushed back. Perhaps the status_update_alert could even have a fixed
-		// array of n entries rather than a vector, to further improve memory
-		// locality.
+		status.reserve(num_updates);
+
 		for (std::vector<torrent*>::iterator i = state_updates.begin()
-			, end(state_updates.end()); i != end; ++i)
+			, end(state_updates.begin() + num_updates); i != end; ++i)
 		{
 			torrent* t = *i;
 			TORRENT_ASSERT(t->m_links[aux::session_impl::torrent_state_updates].in_list());
@@ -4278,16 +4284,43 @@ retry:
 			t->status(&status.back(), flags);
 			t->clear_in_state_update();
 		}
-		state_updates.clear();
+		state_updates.erase(state_updates.begin()
+			, state_updates.begin() + num_updates);
+
+		// the torrents left in the list moved, update their links
+		for (int i = 0; i < int(state_updates.size()); ++i)
+		{
+			TORRENT_ASSERT(state_updates[i]->m_links[aux::session_impl::torrent_state_updates].in_list());
+			state_updates[i]->m_links[aux::session_impl::torrent_state_updates].index = i;
+		}
 
 #if TORRENT_USE_ASSERTS
 		m_posting_torrent_updates = false;
 #endif
 
+#ifndef BOOST_NO_CXX11_RVALUE_REFERENCES
+		m_alerts.emplace_alert<state_update_alert>(std::move(status));
+#else
 		m_alerts.emplace_alert<state_update_alert>(status);
+#endif
 	}
 
 	void session_impl::post_session_stats()
+	{
+		update_stats_gauges();
+		m_alerts.emplace_alert<session_stats_alert>(m_stats_counters);
+	}
+
+	void session_impl::post_session_stats_delta()
+	{
+		update_stats_gauges();
+		if (m_stats_delta_snapshot.empty())
+			m_stats_delta_snapshot.resize(counters::num_counters, 0);
+		m_alerts.emplace_alert<session_stats_delta_alert>(m_stats_counters
+			, &m_stats_delta_snapshot[0]);
+	}
+
+	void session_impl::update_stats_gauges()
 	{
 		m_disk_thread.update_stats_counters(m_stats_counters);
 
@@ -4306,8 +4339,6 @@ retry:
 			, m_upload_rate.queued_bytes());
 		m_stats_counters.set_value(counters::limiter_down_bytes
 			, m_download_rate.queued_bytes());
-
-		m_alerts.emplace_alert<session_stats_alert>(m_stats_counters);
 	}
 
 	void session_impl::post_dht_stats()
@@ -5823,17 +5854,24 @@ retry:
 
 	void session_impl::post_socket_job(socket_job& j)
 	{
-		uintptr_t idx = 0;
+		int idx = 0;
 		if (m_net_thread_pool.size() > 1)
 		{
 			// each peer needs to be pinned to a specific thread
 			// since reading and writing simultaneously on the same
 			// socket from different threads is not supported by asio.
 			// as long as a specific socket is consistently used from
-			// the same thread, it's safe
-			idx = uintptr_t(j.peer.get());
-			idx ^= idx >> 8;
-			idx %= m_net_thread_pool.size();
+			// the same thread, it's safe. Peers are assigned threads
+			// round-robin the first time they post a job, to spread the
+			// load evenly across them
+			idx = j.peer->network_thread();
+			if (idx < 0)
+			{
+				idx = m_next_network_thread;
+				m_next_network_thread = (m_next_network_thread + 1) & 0x7fff;
+				j.peer->set_network_thread(idx);
+			}
+			idx %= int(m_net_thread_pool.size());
 		}
 		m_net_thread_pool[idx]->post_job(j);
 	}
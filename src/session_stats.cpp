@@ -300,6 +300,12 @@ namespace libtorrent
 		METRIC(picker, piece_picker_rand_loops)
 		METRIC(picker, piece_picker_busy_loops)
 
+		// the number of calls into the piece picker to pick blocks to
+		// request from a peer, and the cumulative time spent in those
+		// calls. Measured in microseconds
+		METRIC(picker, piece_picker_calls)
+		METRIC(picker, piece_picker_time)
+
 		// This breaks down the piece picks into the event that
 		// triggered it
 		METRIC(picker, reject_piece_picks)
@@ -363,6 +369,11 @@ namespace libtorrent
 		// hash a piece (when verifying against the piece hash)
 		METRIC(disk, num_read_back)
 
+		// the number of queued read jobs the storage was told about ahead of
+		// time, to let the operating system start reading them in the
+		// background (see the ``read_ahead_jobs`` setting)
+		METRIC(disk, num_read_hints)
+
 		// cumulative time spent in various disk jobs, as well
 		// as total for all disk jobs. Measured in microseconds
 		METRIC(disk, disk_read_time)
@@ -461,6 +472,20 @@ namespace libtorrent
 		METRIC(utp, utp_invalid_pkts_in)
 		METRIC(utp, utp_redundant_pkts_in)
 
+		// the number of incoming uTP packets that had to be looked up in the
+		// socket table (i.e. didn't go to the same socket as the previous
+		// packet) and the total number of sockets that were compared against
+		// the packet's endpoint during those lookups. The ratio is the
+		// average lookup cost
+		METRIC(utp, utp_socket_lookups)
+		METRIC(utp, utp_socket_lookup_probes)
+
+		// the number of uTP packet buffers that were taken from the packet
+		// pool, and the number that had to be allocated from the heap because
+		// the pool was empty
+		METRIC(utp, utp_packet_pool_hits)
+		METRIC(utp, utp_packet_pool_misses)
+
 		// the number of uTP sockets in each respective state
 		METRIC(utp, num_utp_idle)
 		METRIC(utp, num_utp_syn_sent)
@@ -14,6 +14,11 @@ changelog at the end of the file.
 #include <cstring>
 
 #include "libtorrent/sha1.hpp"
+#include "libtorrent/aux_/cpuid.hpp"
+
+#if TORRENT_HAS_SHA_NI
+#include <immintrin.h>
+#endif
 
 typedef boost::uint32_t u32;
 typedef boost::uint8_t u8;
@@ -108,6 +113,210 @@ namespace
 		state[4] += e;
 	}
 
+#if TORRENT_HAS_SHA_NI
+	// Hash ``num_blocks`` consecutive 512-bit blocks using the SHA extensions.
+	// This must only be called if aux::sha_support is true
+#ifdef __GNUC__
+	__attribute__((target("sha,sse4.1")))
+#endif
+	void SHA1transform_ni(u32 state[5], u8 const* data, u32 num_blocks)
+	{
+		__m128i const mask = _mm_set_epi64x(0x0001020304050607ULL
+			, 0x08090a0b0c0d0e0fULL);
+
+		__m128i abcd = _mm_shuffle_epi32(_mm_loadu_si128(
+			reinterpret_cast<__m128i const*>(state)), 0x1b);
+		__m128i e0 = _mm_set_epi32(int(state[4]), 0, 0, 0);
+		__m128i e1;
+		__m128i msg0, msg1, msg2, msg3;
+
+		for (; num_blocks > 0; --num_blocks, data += 64)
+		{
+			__m128i const abcd_save = abcd;
+			__m128i const e0_save = e0;
+
+			// rounds 0-3
+			msg0 = _mm_shuffle_epi8(_mm_loadu_si128(
+				reinterpret_cast<__m128i const*>(data + 0)), mask);
+			e0 = _mm_add_epi32(e0, msg0);
+			e1 = abcd;
+			abcd = _mm_sha1rnds4_epu32(abcd, e0, 0);
+
+			// rounds 4-7
+			msg1 = _mm_shuffle_epi8(_mm_loadu_si128(
+				reinterpret_cast<__m128i const*>(data + 16)), mask);
+			e1 = _mm_sha1nexte_epu32(e1, msg1);
+			e0 = abcd;
+			abcd = _mm_sha1rnds4_epu32(abcd, e1, 0);
+			msg0 = _mm_sha1msg1_epu32(msg0, msg1);
+
+			// rounds 8-11
+			msg2 = _mm_shuffle_epi8(_mm_loadu_si128(
+				reinterpret_cast<__m128i const*>(data + 32)), mask);
+			e0 = _mm_sha1nexte_epu32(e0, msg2);
+			e1 = abcd;
+			abcd = _mm_sha1rnds4_epu32(abcd, e0, 0);
+			msg1 = _mm_sha1msg1_epu32(msg1, msg2);
+			msg0 = _mm_xor_si128(msg0, msg2);
+
+			// rounds 12-15
+			msg3 = _mm_shuffle_epi8(_mm_loadu_si128(
+				reinterpret_cast<__m128i const*>(data + 48)), mask);
+			e1 = _mm_sha1nexte_epu32(e1, msg3);
+			e0 = abcd;
+			msg0 = _mm_sha1msg2_epu32(msg0, msg3);
+			abcd = _mm_sha1rnds4_epu32(abcd, e1, 0);
+			msg2 = _mm_sha1msg1_epu32(msg2, msg3);
+			msg1 = _mm_xor_si128(msg1, msg3);
+
+			// rounds 16-19
+			e0 = _mm_sha1nexte_epu32(e0, msg0);
+			e1 = abcd;
+			msg1 = _mm_sha1msg2_epu32(msg1, msg0);
+			abcd = _mm_sha1rnds4_epu32(abcd, e0, 0);
+			msg3 = _mm_sha1msg1_epu32(msg3, msg0);
+			msg2 = _mm_xor_si128(msg2, msg0);
+
+			// rounds 20-23
+			e1 = _mm_sha1nexte_epu32(e1, msg1);
+			e0 = abcd;
+			msg2 = _mm_sha1msg2_epu32(msg2, msg1);
+			abcd = _mm_sha1rnds4_epu32(abcd, e1, 1);
+			msg0 = _mm_sha1msg1_epu32(msg0, msg1);
+			msg3 = _mm_xor_si128(msg3, msg1);
+
+			// rounds 24-27
+			e0 = _mm_sha1nexte_epu32(e0, msg2);
+			e1 = abcd;
+			msg3 = _mm_sha1msg2_epu32(msg3, msg2);
+			abcd = _mm_sha1rnds4_epu32(abcd, e0, 1);
+			msg1 = _mm_sha1msg1_epu32(msg1, msg2);
+			msg0 = _mm_xor_si128(msg0, msg2);
+
+			// rounds 28-31
+			e1 = _mm_sha1nexte_epu32(e1, msg3);
+			e0 = abcd;
+			msg0 = _mm_sha1msg2_epu32(msg0, msg3);
+			abcd = _mm_sha1rnds4_epu32(abcd, e1, 1);
+			msg2 = _mm_sha1msg1_epu32(msg2, msg3);
+			msg1 = _mm_xor_si128(msg1, msg3);
+
+			// rounds 32-35
+			e0 = _mm_sha1nexte_epu32(e0, msg0);
+			e1 = abcd;
+			msg1 = _mm_sha1msg2_epu32(msg1, msg0);
+			abcd = _mm_sha1rnds4_epu32(abcd, e0, 1);
+			msg3 = _mm_sha1msg1_epu32(msg3, msg0);
+			msg2 = _mm_xor_si128(msg2, msg0);
+
+			// rounds 36-39
+			e1 = _mm_sha1nexte_epu32(e1, msg1);
+			e0 = abcd;
+			msg2 = _mm_sha1msg2_epu32(msg2, msg1);
+			abcd = _mm_sha1rnds4_epu32(abcd, e1, 1);
+			msg0 = _mm_sha1msg1_epu32(msg0, msg1);
+			msg3 = _mm_xor_si128(msg3, msg1);
+
+			// rounds 40-43
+			e0 = _mm_sha1nexte_epu32(e0, msg2);
+			e1 = abcd;
+			msg3 = _mm_sha1msg2_epu32(msg3, msg2);
+			abcd = _mm_sha1rnds4_epu32(abcd, e0, 2);
+			msg1 = _mm_sha1msg1_epu32(msg1, msg2);
+			msg0 = _mm_xor_si128(msg0, msg2);
+
+			// rounds 44-47
+			e1 = _mm_sha1nexte_epu32(e1, msg3);
+			e0 = abcd;
+			msg0 = _mm_sha1msg2_epu32(msg0, msg3);
+			abcd = _mm_sha1rnds4_epu32(abcd, e1, 2);
+			msg2 = _mm_sha1msg1_epu32(msg2, msg3);
+			msg1 = _mm_xor_si128(msg1, msg3);
+
+			// rounds 48-51
+			e0 = _mm_sha1nexte_epu32(e0, msg0);
+			e1 = abcd;
+			msg1 = _mm_sha1msg2_epu32(msg1, msg0);
+			abcd = _mm_sha1rnds4_epu32(abcd, e0, 2);
+			msg3 = _mm_sha1msg1_epu32(msg3, msg0);
+			msg2 = _mm_xor_si128(msg2, msg0);
+
+			// rounds 52-55
+			e1 = _mm_sha1nexte_epu32(e1, msg1);
+			e0 = abcd;
+			msg2 = _mm_sha1msg2_epu32(msg2, msg1);
+			abcd = _mm_sha1rnds4_epu32(abcd, e1, 2);
+			msg0 = _mm_sha1msg1_epu32(msg0, msg1);
+			msg3 = _mm_xor_si128(msg3, msg1);
+
+			// rounds 56-59
+			e0 = _mm_sha1nexte_epu32(e0, msg2);
+			e1 = abcd;
+			msg3 = _mm_sha1msg2_epu32(msg3, msg2);
+			abcd = _mm_sha1rnds4_epu32(abcd, e0, 2);
+			msg1 = _mm_sha1msg1_epu32(msg1, msg2);
+			msg0 = _mm_xor_si128(msg0, msg2);
+
+			// rounds 60-63
+			e1 = _mm_sha1nexte_epu32(e1, msg3);
+			e0 = abcd;
+			msg0 = _mm_sha1msg2_epu32(msg0, msg3);
+			abcd = _mm_sha1rnds4_epu32(abcd, e1, 3);
+			msg2 = _mm_sha1msg1_epu32(msg2, msg3);
+			msg1 = _mm_xor_si128(msg1, msg3);
+
+			// rounds 64-67
+			e0 = _mm_sha1nexte_epu32(e0, msg0);
+			e1 = abcd;
+			msg1 = _mm_sha1msg2_epu32(msg1, msg0);
+			abcd = _mm_sha1rnds4_epu32(abcd, e0, 3);
+			msg3 = _mm_sha1msg1_epu32(msg3, msg0);
+			msg2 = _mm_xor_si128(msg2, msg0);
+
+			// rounds 68-71
+			e1 = _mm_sha1nexte_epu32(e1, msg1);
+			e0 = abcd;
+			msg2 = _mm_sha1msg2_epu32(msg2, msg1);
+			abcd = _mm_sha1rnds4_epu32(abcd, e1, 3);
+			msg3 = _mm_xor_si128(msg3, msg1);
+
+			// rounds 72-75
+			e0 = _mm_sha1nexte_epu32(e0, msg2);
+			e1 = abcd;
+			msg3 = _mm_sha1msg2_epu32(msg3, msg2);
+			abcd = _mm_sha1rnds4_epu32(abcd, e0, 3);
+
+			// rounds 76-79
+			e1 = _mm_sha1nexte_epu32(e1, msg3);
+			e0 = abcd;
+			abcd = _mm_sha1rnds4_epu32(abcd, e1, 3);
+
+			e0 = _mm_sha1nexte_epu32(e0, e0_save);
+			abcd = _mm_add_epi32(abcd, abcd_save);
+		}
+
+		abcd = _mm_shuffle_epi32(abcd, 0x1b);
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(state), abcd);
+		state[4] = u32(_mm_extract_epi32(e0, 3));
+	}
+#endif // TORRENT_HAS_SHA_NI
+
+	// Hash ``num_blocks`` consecutive 512-bit blocks, with the fastest
+	// transform this CPU supports
+	template <class BlkFun>
+	void SHA1transform_blocks(u32 state[5], u8 const* data, u32 num_blocks)
+	{
+#if TORRENT_HAS_SHA_NI
+		if (aux::sha_support)
+		{
+			SHA1transform_ni(state, data, num_blocks);
+			return;
+		}
+#endif
+		for (; num_blocks > 0; --num_blocks, data += 64)
+			SHA1transform<BlkFun>(state, data);
+	}
+
 #ifdef VERBOSE
 	void SHAPrintContext(sha_ctx *context, char *msg)
 	{
@@ -138,11 +347,10 @@ namespace
 		if ((j + len) > 63)
 		{
 			memcpy(&context->buffer[j], data, (i = 64-j));
-			SHA1transform<BlkFun>(context->state, context->buffer);
-			for ( ; i + 63 < len; i += 64)
-			{
-				SHA1transform<BlkFun>(context->state, &data[i]);
-			}
+			SHA1transform_blocks<BlkFun>(context->state, context->buffer, 1);
+			u32 const num_blocks = (len - i) / 64;
+			SHA1transform_blocks<BlkFun>(context->state, &data[i], num_blocks);
+			i += num_blocks * 64;
 			j = 0;
 		}
 		else
@@ -1096,6 +1096,106 @@ namespace libtorrent
 		return readwritev(bufs, slot, offset, num_bufs, op, ec);
 	}
 
+	void default_storage::hint_read(int slot, int offset, int len, int flags)
+	{
+		TORRENT_ASSERT(slot >= 0);
+		TORRENT_ASSERT(slot < m_files.num_pieces());
+		TORRENT_ASSERT(offset >= 0);
+		TORRENT_ASSERT(len > 0);
+
+		boost::int64_t torrent_offset = slot * boost::int64_t(m_files.piece_length()) + offset;
+		int file_index = files().file_index_at_offset(torrent_offset);
+		boost::int64_t file_offset = torrent_offset - files().file_offset(file_index);
+
+		for (; len > 0 && file_index < files().num_files(); ++file_index, file_offset = 0)
+		{
+			int file_bytes = int((std::min)(boost::int64_t(len)
+				, files().file_size(file_index) - file_offset));
+			if (file_bytes <= 0) continue;
+			len -= file_bytes;
+
+			// pad files and files with priority 0 are not read from their
+			// files on disk
+			if (files().pad_file_at(file_index)
+				|| (file_index < int(m_file_priority.size())
+					&& m_file_priority[file_index] == 0))
+				continue;
+
+			error_code ec;
+			file_handle handle = open_file_impl(file_index, file::read_only | flags, ec);
+			if (ec) continue;
+
+			handle->hint_read(
+#ifndef TORRENT_NO_DEPRECATE
+				files().file_base_deprecated(file_index) +
+#endif
+				file_offset, file_bytes);
+		}
+	}
+
+	bool default_storage::open_file_slices(int slot, int offset, int size
+		, int flags, std::vector<open_file_slice>& slices)
+	{
+		TORRENT_ASSERT(slot >= 0);
+		TORRENT_ASSERT(slot < m_files.num_pieces());
+		TORRENT_ASSERT(offset >= 0);
+		TORRENT_ASSERT(size > 0);
+		TORRENT_ASSERT(slices.empty());
+
+		// files opened without the OS cache can't be sent from
+		if (m_settings
+			&& settings().get_int(settings_pack::disk_io_write_mode)
+			== settings_pack::disable_os_cache)
+			return false;
+
+		boost::int64_t torrent_offset = slot * boost::int64_t(m_files.piece_length()) + offset;
+		int file_index = files().file_index_at_offset(torrent_offset);
+		boost::int64_t file_offset = torrent_offset - files().file_offset(file_index);
+
+		for (; size > 0 && file_index < files().num_files(); ++file_index, file_offset = 0)
+		{
+			int file_bytes = int((std::min)(boost::int64_t(size)
+				, files().file_size(file_index) - file_offset));
+			if (file_bytes <= 0) continue;
+			size -= file_bytes;
+
+			// pad files and files with priority 0 are not read from their
+			// files on disk
+			if (files().pad_file_at(file_index)
+				|| (file_index < int(m_file_priority.size())
+					&& m_file_priority[file_index] == 0))
+			{
+				slices.clear();
+				return false;
+			}
+
+			error_code ec;
+			file_handle handle = open_file_impl(file_index, file::read_only | flags, ec);
+			if (ec)
+			{
+				slices.clear();
+				return false;
+			}
+
+			open_file_slice s;
+			s.file = handle;
+			s.offset =
+#ifndef TORRENT_NO_DEPRECATE
+				files().file_base_deprecated(file_index) +
+#endif
+				file_offset;
+			s.size = file_bytes;
+
+			// the data is sent from the network thread. Start reading it into
+			// the page cache now, to make it less likely to block on the disk
+			handle->hint_read(s.offset, s.size);
+
+			slices.push_back(s);
+		}
+		TORRENT_ASSERT(size == 0);
+		return true;
+	}
+
 	// much of what needs to be done when reading and writing 
 	// is buffer management and piece to file mapping. Most
 	// of that is the same for reading and writing. This function
@@ -1375,6 +1475,26 @@ namespace libtorrent
 		return new default_storage(params);
 	}
 
+	// -- mmap_storage ------------------------------------------------------
+
+	int mmap_storage::readv(file::iovec_t const* bufs, int num_bufs
+		, int slot, int offset, int flags, storage_error& ec)
+	{
+		return default_storage::readv(bufs, num_bufs, slot, offset
+			, flags | file::memory_map, ec);
+	}
+
+	void mmap_storage::hint_read(int slot, int offset, int len, int flags)
+	{
+		// open the files the same way readv() will, to avoid re-opening them
+		default_storage::hint_read(slot, offset, len, flags | file::memory_map);
+	}
+
+	storage_interface* mmap_storage_constructor(storage_params const& params)
+	{
+		return new mmap_storage(params);
+	}
+
 	int disabled_storage::readv(file::iovec_t const*
 		, int, int, int, int, storage_error&)
 	{
@@ -1627,6 +1747,27 @@ namespace libtorrent
 			return ret;
 		}
 
+		return post_fence_job(jobs);
+	}
+
+	bool disk_job_fence::try_pin()
+	{
+		mutex::scoped_lock l(m_mutex);
+		if (m_has_fence) return false;
+		++m_outstanding_jobs;
+		return true;
+	}
+
+	int disk_job_fence::unpin(tailqueue& jobs)
+	{
+		mutex::scoped_lock l(m_mutex);
+		TORRENT_ASSERT(m_outstanding_jobs > 0);
+		--m_outstanding_jobs;
+		return post_fence_job(jobs);
+	}
+
+	int disk_job_fence::post_fence_job(tailqueue& jobs)
+	{
 		// there are still outstanding jobs, even if we have a
 		// fence, it's not time to lower it yet
 		// also, if we don't have a fence, we're done
@@ -4833,7 +4833,13 @@ namespace libtorrent
 		for (int i = 0; i < aux::session_interface::num_torrent_lists; ++i)
 		{
 			if (!m_links[i].in_list()) continue;
-			m_links[i].unlink(m_ses.torrent_list(i), i);
+			// the state update list is posted in order, in chunks of
+			// max_state_updates. Don't let the last torrent in it jump the
+			// queue
+			if (i == aux::session_interface::torrent_state_updates)
+				m_links[i].erase(m_ses.torrent_list(i), i);
+			else
+				m_links[i].unlink(m_ses.torrent_list(i), i);
 		}
 		// don't re-add this torrent to the state-update list
 		m_state_subscription = false;
@@ -6901,8 +6907,21 @@ namespace libtorrent
 		if (valid_metadata())
 		{
 			if (m_magnet_link || (m_save_resume_flags & torrent_handle::save_info_dict))
-				ret["info"] = bdecode(&torrent_file().metadata()[0]
-					, &torrent_file().metadata()[0] + torrent_file().metadata_size());
+			{
+				char const* info = &torrent_file().metadata()[0];
+				if (m_save_resume_flags & torrent_handle::preformatted_info_dict)
+				{
+					// the info-dictionary is already bencoded. Store it verbatim
+					// rather than expanding it into an entry tree, which is
+					// expensive for large torrents
+					ret["info"] = entry::preformatted_type(info
+						, info + torrent_file().metadata_size());
+				}
+				else
+				{
+					ret["info"] = bdecode(info, info + torrent_file().metadata_size());
+				}
+			}
 		}
 
 		// blocks per piece
@@ -6938,14 +6957,18 @@ namespace libtorrent
 			{
 				if (i->finished == 0) continue;
 
-				entry piece_struct(entry::dictionary_t);
+				// build the struct in place on the unfinished-piece list,
+				// to avoid deep-copying it
+				up.push_back(entry(entry::dictionary_t));
+				entry& piece_struct = up.back();
 
 				// the unfinished piece's index
 				piece_struct["piece"] = i->index;
 
-				std::string bitmask;
 				const int num_bitmask_bytes
 					= (std::max)(num_blocks_per_piece / 8, 1);
+				std::string& bitmask = piece_struct["bitmask"].string();
+				bitmask.reserve(num_bitmask_bytes);
 
 				piece_picker::block_info const* info = m_picker->blocks_for_piece(*i);
 				for (int j = 0; j < num_bitmask_bytes; ++j)
@@ -6958,9 +6981,6 @@ namespace libtorrent
 					bitmask.append(1, v);
 					TORRENT_ASSERT(bits == 8 || j == num_bitmask_bytes - 1);
 				}
-				piece_struct["bitmask"] = bitmask;
-				// push the struct onto the unfinished-piece list
-				up.push_back(piece_struct);
 			}
 		}
 
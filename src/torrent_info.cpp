@@ -699,6 +699,7 @@ namespace libtorrent
 		, m_nodes(t.m_nodes)
 		, m_merkle_tree(t.m_merkle_tree)
 		, m_piece_hashes(t.m_piece_hashes)
+		, m_ssl_cert(t.m_ssl_cert)
 		, m_comment(t.m_comment)
 		, m_created_by(t.m_created_by)
 		, m_creation_date(t.m_creation_date)
@@ -740,6 +741,8 @@ namespace libtorrent
 			m_info_dict.switch_underlying_buffer(m_info_section.get());
 		}
 
+		if (m_ssl_cert.first) m_ssl_cert.first += offset;
+
 		m_piece_hashes += offset;
 		TORRENT_ASSERT(m_piece_hashes >= m_info_section.get());
 		TORRENT_ASSERT(m_piece_hashes < m_info_section.get() + m_info_section_size);
@@ -1142,6 +1145,9 @@ namespace libtorrent
 
 		m_info_section.reset();
 		m_info_section_size = 0;
+		m_info_dict.clear();
+		m_ssl_cert.first = NULL;
+		m_ssl_cert.second = 0;
 
 		// if we have orig_files, we have to keep
 		// m_files around, since it means we have
@@ -1192,6 +1198,7 @@ namespace libtorrent
 		swap(m_info_section, ti.m_info_section);
 		SWAP(m_info_section_size, ti.m_info_section_size);
 		swap(m_piece_hashes, ti.m_piece_hashes);
+		swap(m_ssl_cert, ti.m_ssl_cert);
 		m_info_dict.swap(ti.m_info_dict);
 		swap(m_merkle_tree, ti.m_merkle_tree);
 		SWAP(m_merkle_first_leaf, ti.m_merkle_first_leaf);
@@ -1201,16 +1208,8 @@ namespace libtorrent
 
 	std::string torrent_info::ssl_cert() const
 	{
-		// this is parsed lazily
-		if (!m_info_dict)
-		{
-			error_code ec;
-			bdecode(m_info_section.get(), m_info_section.get()
-				+ m_info_section_size, m_info_dict, ec);
-			if (ec) return "";
-		}
-		if (m_info_dict.type() != bdecode_node::dict_t) return "";
-		return m_info_dict.dict_find_string_value("ssl-cert");
+		if (m_ssl_cert.first == NULL) return "";
+		return std::string(m_ssl_cert.first, m_ssl_cert.second);
 	}
 
 	bool torrent_info::parse_info_section(bdecode_node const& info
@@ -1284,6 +1283,9 @@ namespace libtorrent
 		}
 		TORRENT_ASSERT(!files.name().empty());
 
+		// the path index is only needed while adding the files
+		files.free_path_index();
+
 		// extract sha-1 hashes for all pieces
 		// we want this division to round upwards, that's why we have the
 		// extra addition
@@ -1329,6 +1331,18 @@ namespace libtorrent
 
 		m_private = info.dict_find_int_value("private", 0);
 
+		bdecode_node ssl_cert = info.dict_find_string("ssl-cert");
+		if (ssl_cert)
+		{
+			m_ssl_cert.first = ssl_cert.string_ptr() + info_ptr_diff;
+			m_ssl_cert.second = ssl_cert.string_length();
+		}
+		else
+		{
+			m_ssl_cert.first = NULL;
+			m_ssl_cert.second = 0;
+		}
+
 #ifndef TORRENT_DISABLE_MUTABLE_TORRENTS
 		bdecode_node similar = info.dict_find_list("similar");
 		if (similar)
@@ -55,8 +55,32 @@ POSSIBILITY OF SUCH DAMAGE.
 #include "libtorrent/debug.hpp"
 #endif
 
+#if TORRENT_USE_RECVMMSG
+#include <sys/socket.h>
+#include <errno.h>
+#endif
+
 using namespace libtorrent;
 
+namespace {
+
+#if TORRENT_USE_RECVMMSG
+	// the max number of datagrams to receive in a single recvmmsg() call
+	const int max_read_batch = 32;
+
+	// the number of receive buffer slots (of buf_size bytes each) to use.
+	// Large buffers (for interfaces with large MTUs) get fewer slots, to
+	// keep the total size of the receive buffer bounded
+	int read_batch_size(int buf_size)
+	{
+		if (buf_size <= 0) return 1;
+		return (std::max)(1, (std::min)(max_read_batch, 256 * 1024 / buf_size));
+	}
+#else
+	int read_batch_size(int) { return 1; }
+#endif
+}
+
 udp_socket::udp_socket(asio::io_service& ios)
 	: m_observers_locked(false)
 	, m_ipv4_sock(ios)
@@ -64,6 +88,9 @@ udp_socket::udp_socket(asio::io_service& ios)
 	, m_buf_size(0)
 	, m_new_buf_size(0)
 	, m_buf(0)
+#if TORRENT_USE_RECVMMSG
+	, m_buf_in_use(false)
+#endif
 #if TORRENT_USE_IPV6
 	, m_ipv6_sock(ios)
 #endif
@@ -96,7 +123,7 @@ udp_socket::udp_socket(asio::io_service& ios)
 
 	m_buf_size = 2048;
 	m_new_buf_size = m_buf_size;
-	m_buf = (char*)malloc(m_buf_size);
+	m_buf = (char*)malloc(m_buf_size * read_batch_size(m_buf_size));
 }
 
 udp_socket::~udp_socket()
@@ -283,6 +310,56 @@ void udp_socket::on_read(error_code const& ec, udp::socket* s)
 
 	for (;;)
 	{
+#if TORRENT_USE_RECVMMSG
+		// receive as many datagrams as we have buffer slots for in a single
+		// system call, and then hand them to the observers one at a time
+		int const num_bufs = read_batch_size(m_buf_size);
+		TORRENT_ASSERT(num_bufs <= max_read_batch);
+		mmsghdr msgs[max_read_batch];
+		iovec iov[max_read_batch];
+		sockaddr_storage addrs[max_read_batch];
+		for (int i = 0; i < num_bufs; ++i)
+		{
+			iov[i].iov_base = m_buf + i * m_buf_size;
+			iov[i].iov_len = m_buf_size;
+			memset(&msgs[i], 0, sizeof(msgs[i]));
+			msgs[i].msg_hdr.msg_name = &addrs[i];
+			msgs[i].msg_hdr.msg_namelen = sizeof(addrs[i]);
+			msgs[i].msg_hdr.msg_iov = &iov[i];
+			msgs[i].msg_hdr.msg_iovlen = 1;
+		}
+
+		int const ret = recvmmsg(s->native_handle(), msgs, num_bufs, 0, NULL);
+		if (ret < 0)
+		{
+			error_code ec(errno, system_category());
+			if (ec == asio::error::would_block || ec == asio::error::try_again) break;
+			on_read_impl(udp::endpoint(), ec, m_buf, 0);
+			continue;
+		}
+
+		m_buf_in_use = true;
+		for (int i = 0; i < ret; ++i)
+		{
+			udp::endpoint ep;
+			std::size_t const addr_len = msgs[i].msg_hdr.msg_namelen;
+			if (addr_len > ep.capacity()) continue;
+			memcpy(ep.data(), &addrs[i], addr_len);
+			ep.resize(addr_len);
+			on_read_impl(ep, error_code(), m_buf + i * m_buf_size, msgs[i].msg_len);
+		}
+		m_buf_in_use = false;
+
+		// now that we're done with the buffer, we may resize it
+		if (m_new_buf_size != m_buf_size)
+		{
+			set_buf_size(m_new_buf_size);
+			if (m_buf_size == 0) return;
+		}
+
+		// if we didn't fill all the slots, the socket has been drained
+		if (ret < num_bufs) break;
+#else
 		error_code ec;
 		udp::endpoint ep;
 		size_t bytes_transferred = s->receive_from(asio::buffer(m_buf, m_buf_size), ep, 0, ec);
@@ -302,7 +379,8 @@ void udp_socket::on_read(error_code const& ec, udp::socket* s)
 #endif
 
 		if (ec == asio::error::would_block || ec == asio::error::try_again) break;
-		on_read_impl(ep, ec, bytes_transferred);
+		on_read_impl(ep, ec, m_buf, bytes_transferred);
+#endif
 	}
 	call_drained_handler();
 	setup_read(s);
@@ -420,7 +498,7 @@ void udp_socket::unsubscribe(udp_socket_observer* o)
 }
 
 void udp_socket::on_read_impl(udp::endpoint const& ep
-	, error_code const& e, std::size_t bytes_transferred)
+	, error_code const& e, char const* buf, std::size_t bytes_transferred)
 {
 	TORRENT_ASSERT(m_magic == 0x1337);
 	TORRENT_ASSERT(is_single_thread());
@@ -464,11 +542,11 @@ void udp_socket::on_read_impl(udp::endpoint const& ep
 		{
 			// if the source IP doesn't match the proxy's, ignore the packet
 			if (ep == m_udp_proxy_addr)
-				unwrap(e, m_buf, bytes_transferred);
+				unwrap(e, buf, bytes_transferred);
 		}
 		else if (!m_force_proxy) // block incoming packets that aren't coming via the proxy
 		{
-			call_handler(e, ep, m_buf, bytes_transferred);
+			call_handler(e, ep, buf, bytes_transferred);
 		}
 
 	} TORRENT_CATCH (std::exception&) {}
@@ -646,7 +724,11 @@ void udp_socket::set_buf_size(int s)
 {
 	TORRENT_ASSERT(is_single_thread());
 
-	if (m_observers_locked)
+	bool buf_in_use = m_observers_locked;
+#if TORRENT_USE_RECVMMSG
+	buf_in_use |= m_buf_in_use;
+#endif
+	if (buf_in_use)
 	{
 		// we can't actually reallocate the buffer while
 		// it's being used by the observers, we have to
@@ -658,7 +740,7 @@ void udp_socket::set_buf_size(int s)
 	if (s == m_buf_size) return;
 
 	bool no_mem = false;
-	void* tmp = realloc(m_buf, s);
+	void* tmp = realloc(m_buf, s * read_batch_size(s));
 	if (tmp != 0)
 	{
 		m_buf = (char*)tmp;
@@ -69,6 +69,12 @@ namespace libtorrent
 		{
 			delete_utp_impl(i->second);
 		}
+
+		for (std::vector<void*>::iterator i = m_packet_pool.begin()
+			, end(m_packet_pool.end()); i != end; ++i)
+		{
+			free(*i);
+		}
 	}
 
 	void utp_socket_manager::tick(time_point now)
@@ -286,13 +292,18 @@ namespace libtorrent
 		std::pair<socket_map_t::iterator, socket_map_t::iterator> r =
 			m_utp_sockets.equal_range(id);
 
+		m_counters.inc_stats_counter(counters::utp_socket_lookups);
+		int probes = 0;
 		for (; r.first != r.second; ++r.first)
 		{
+			++probes;
 			if (!utp_match(r.first->second, ep, id)) continue;
+			m_counters.inc_stats_counter(counters::utp_socket_lookup_probes, probes);
 			bool ret = utp_incoming_packet(r.first->second, p, size, ep, receive_time);
 			if (ret) m_last_socket = r.first->second;
 			return ret;
 		}
+		m_counters.inc_stats_counter(counters::utp_socket_lookup_probes, probes);
 
 //		UTP_LOGV("incoming packet id:%d source:%s\n", id, print_endpoint(ep).c_str());
 
@@ -433,6 +444,34 @@ namespace libtorrent
 		m_sock_buf_size = size;
 	}
 
+	void* utp_socket_manager::alloc_packet(int size)
+	{
+		if (size > packet_buffer_size) return malloc(size);
+
+		if (m_packet_pool.empty())
+		{
+			m_counters.inc_stats_counter(counters::utp_packet_pool_misses);
+			return malloc(packet_buffer_size);
+		}
+
+		m_counters.inc_stats_counter(counters::utp_packet_pool_hits);
+		void* ret = m_packet_pool.back();
+		m_packet_pool.pop_back();
+		return ret;
+	}
+
+	void utp_socket_manager::free_packet(void* p, int size)
+	{
+		if (p == NULL) return;
+		if (size > packet_buffer_size
+			|| int(m_packet_pool.size()) >= max_pooled_packets)
+		{
+			free(p);
+			return;
+		}
+		m_packet_pool.push_back(p);
+	}
+
 	void utp_socket_manager::inc_stats_counter(int counter, int delta)
 	{
 		TORRENT_ASSERT((counter >= counters::utp_packet_loss
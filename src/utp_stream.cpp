@@ -316,6 +316,11 @@ struct utp_socket_impl
 	void defer_ack();
 	void remove_sack_header(packet* p);
 
+	// allocates a packet with room for ``size`` bytes in its buffer (and
+	// sets ``allocated``). Packets are pooled by the socket manager
+	packet* acquire_packet(int size);
+	void release_packet(packet* p);
+
 	enum packet_flags_t { pkt_ack = 1, pkt_fin = 2 };
 	bool send_pkt(int flags = 0);
 	bool resend_packet(packet* p, bool fast_resend = false);
@@ -1076,7 +1081,7 @@ size_t utp_stream::read_some(bool clear_buffers)
 		// Consumed entire packet
 		if (p->header_size == p->size)
 		{
-			free(p);
+			m_impl->release_packet(p);
 			++pop_packets;
 			*i = 0;
 			++i;
@@ -1171,24 +1176,22 @@ utp_socket_impl::~utp_socket_impl()
 		+ m_inbuf.capacity()) & ACK_MASK);
 		i != end; i = (i + 1) & ACK_MASK)
 	{
-		void* p = m_inbuf.remove(i);
-		free(p);
+		release_packet((packet*)m_inbuf.remove(i));
 	}
 	for (boost::uint16_t i = m_outbuf.cursor(), end((m_outbuf.cursor()
 		+ m_outbuf.capacity()) & ACK_MASK);
 		i != end; i = (i + 1) & ACK_MASK)
 	{
-		void* p = m_outbuf.remove(i);
-		free(p);
+		release_packet((packet*)m_outbuf.remove(i));
 	}
 
 	for (std::vector<packet*>::iterator i = m_receive_buffer.begin()
 		, end = m_receive_buffer.end(); i != end; ++i)
 	{
-		free(*i);
+		release_packet(*i);
 	}
 
-	free(m_nagle_packet);
+	release_packet(m_nagle_packet);
 	m_nagle_packet = NULL;
 }
 
@@ -1318,7 +1321,7 @@ void utp_socket_impl::send_syn()
 	m_ack_nr = 0;
 	m_fast_resend_seq_nr = m_seq_nr;
 
-	packet* p = (packet*)malloc(sizeof(packet) + sizeof(utp_header));
+	packet* p = acquire_packet(sizeof(utp_header));
 	p->size = sizeof(utp_header);
 	p->header_size = sizeof(utp_header);
 	p->num_transmissions = 0;
@@ -1367,7 +1370,7 @@ void utp_socket_impl::send_syn()
 	}
 	else if (ec)
 	{
-		free(p);
+		release_packet(p);
 		m_error = ec;
 		set_state(UTP_STATE_ERROR_WAIT);
 		test_socket_state();
@@ -1667,27 +1670,43 @@ void utp_socket_impl::remove_sack_header(packet* p)
 	p->size -= sack_size + 2;
 }
 
+packet* utp_socket_impl::acquire_packet(int size)
+{
+	TORRENT_ASSERT(size >= 0);
+	TORRENT_ASSERT(size <= 0xffff);
+	packet* p = (packet*)m_sm->alloc_packet(sizeof(packet) + size);
+	p->allocated = size;
+	return p;
+}
+
+void utp_socket_impl::release_packet(packet* p)
+{
+	if (p == NULL) return;
+	m_sm->free_packet(p, sizeof(packet) + p->allocated);
+}
+
 struct holder
 {
-	holder(char* buf = NULL): m_buf(buf) {}
-	~holder() { free(m_buf); }
+	holder(utp_socket_impl* s): m_sock(s), m_buf(NULL) {}
+	~holder() { m_sock->release_packet(m_buf); }
 
-	void reset(char* buf)
+	void reset(packet* buf)
 	{
-		free(m_buf);
+		m_sock->release_packet(m_buf);
 		m_buf = buf;
 	}
 
-	char* release()
+	packet* release()
 	{
-		char* ret = m_buf;
+		packet* ret = m_buf;
 		m_buf = NULL;
 		return ret;
 	}
 
 private:
 
-	char* m_buf;
+	utp_socket_impl* m_sock;
+	packet* m_buf;
 };
 
 // sends a packet, pulls data from the write buffer (if there's any)
@@ -1811,7 +1830,7 @@ bool utp_socket_impl::send_pkt(int flags)
 
 	// used to free the packet buffer in case we exit the
 	// function early
-	holder buf_holder;
+	holder buf_holder(this);
 
 	// payload size being zero means we're just sending
 	// an force. We should not pick up the nagle packet
@@ -1821,9 +1840,8 @@ bool utp_socket_impl::send_pkt(int flags)
 		// need to keep the packet around (in the outbuf)
 		if (payload_size) 
 		{
-			p = (packet*)malloc(sizeof(packet) + m_mtu);
-			p->allocated = m_mtu;
-			buf_holder.reset((char*)p);
+			p = acquire_packet(m_mtu);
+			buf_holder.reset(p);
 
 			m_sm->inc_stats_counter(counters::utp_payload_pkts_out);
 		}
@@ -2081,7 +2099,7 @@ bool utp_socket_impl::send_pkt(int flags)
 		{
 			TORRENT_ASSERT(((utp_header*)old->buf)->seq_nr == m_seq_nr);
 			if (!old->need_resend) m_bytes_in_flight -= old->size - old->header_size;
-			free(old);
+			release_packet(old);
 		}
 		TORRENT_ASSERT(h->seq_nr == m_seq_nr);
 		m_seq_nr = (m_seq_nr + 1) & ACK_MASK;
@@ -2357,7 +2375,7 @@ void utp_socket_impl::ack_packet(packet* p, time_point const& receive_time
 
 	m_rtt.add_sample(rtt / 1000);
 	if (rtt < min_rtt) min_rtt = rtt;
-	free(p);
+	release_packet(p);
 }
 
 void utp_socket_impl::incoming(boost::uint8_t const* buf, int size, packet* p
@@ -2395,7 +2413,7 @@ void utp_socket_impl::incoming(boost::uint8_t const* buf, int size, packet* p
 		if (size == 0)
 		{
 			TORRENT_ASSERT(p == 0 || p->header_size == p->size);
-			free(p);
+			release_packet(p);
 			return;
 		}
 	}
@@ -2405,7 +2423,7 @@ void utp_socket_impl::incoming(boost::uint8_t const* buf, int size, packet* p
 	if (!p)
 	{
 		TORRENT_ASSERT(buf);
-		p = (packet*)malloc(sizeof(packet) + size);
+		p = acquire_packet(size);
 		p->size = size;
 		p->header_size = 0;
 		memcpy(p->buf, buf, size);
@@ -2539,7 +2557,7 @@ bool utp_socket_impl::consume_incoming_data(
 		}
 
 		// we don't need to save the packet header, just the payload
-		packet* p = (packet*)malloc(sizeof(packet) + payload_size);
+		packet* p = acquire_packet(payload_size);
 		p->size = payload_size;
 		p->header_size = 0;
 		p->num_transmissions = 0;
@@ -0,0 +1,180 @@
+/*
+
+Copyright (c) 2015, Arvid Norberg
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions
+are met:
+
+    * Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright
+      notice, this list of conditions and the following disclaimer in
+      the documentation and/or other materials provided with the distribution.
+    * Neither the name of the author nor the names of its
+      contributors may be used to endorse or promote products derived
+      from this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+// measures how many find_node and get_peers queries a DHT node can answer
+// per second. The node's routing table is filled with random nodes and
+// the queries, with random targets, are encoded up-front, so only the time
+// spent handling them (including building the response) is measured.
+
+#include "libtorrent/kademlia/node.hpp"
+#include "libtorrent/kademlia/dht_observer.hpp"
+#include "libtorrent/kademlia/msg.hpp"
+#include "libtorrent/session_settings.hpp"
+#include "libtorrent/performance_counters.hpp"
+#include "libtorrent/bencode.hpp"
+#include "libtorrent/bdecode.hpp"
+#include "libtorrent/entry.hpp"
+#include "libtorrent/time.hpp"
+
+#include <vector>
+#include <string>
+#include <cstdio>
+#include <cstdlib>
+
+using namespace libtorrent;
+using namespace libtorrent::dht;
+
+namespace {
+
+	struct benchmark_socket : udp_socket_interface
+	{
+		benchmark_socket() : sent(0) {}
+		bool has_quota() { return true; }
+		bool send_packet(entry&, udp::endpoint const&, int)
+		{
+			++sent;
+			return true;
+		}
+		int sent;
+	};
+
+	struct benchmark_observer : dht_observer
+	{
+		void set_external_address(address const&, address const&) {}
+		address external_address() { return address_v4::from_string("236.0.0.1"); }
+		void get_peers(sha1_hash const&) {}
+		void outgoing_get_peers(sha1_hash const&, sha1_hash const&
+			, udp::endpoint const&) {}
+		void announce(sha1_hash const&, address const&, int) {}
+		void log(dht_logger::module_t, char const*, ...) {}
+		void log_packet(message_direction_t, char const*, int
+			, udp::endpoint) {}
+	};
+
+	node_id random_id()
+	{
+		node_id ret;
+		for (int i = 0; i < 20; ++i) ret[i] = std::rand() & 0xff;
+		return ret;
+	}
+
+	udp::endpoint random_ep()
+	{
+		return udp::endpoint(address_v4((std::rand() << 16) ^ std::rand())
+			, std::rand() % 60000 + 1024);
+	}
+
+	std::string encode_query(bool get_peers)
+	{
+		entry e;
+		e["q"] = get_peers ? "get_peers" : "find_node";
+		e["t"] = "10";
+		e["y"] = "q";
+		entry::dictionary_type& a = e["a"].dict();
+		a["id"] = random_id().to_string();
+		a[get_peers ? "info_hash" : "target"] = random_id().to_string();
+		std::string ret;
+		bencode(std::back_inserter(ret), e);
+		return ret;
+	}
+}
+
+int main(int argc, char* argv[])
+{
+	int num_nodes = 2000;
+	int num_queries = 1000000;
+	if (argc > 1) num_nodes = atoi(argv[1]);
+	if (argc > 2) num_queries = atoi(argv[2]);
+
+	if (argc > 3 || num_nodes <= 0 || num_queries <= 0)
+	{
+		fputs("usage: dht_benchmark [num-nodes [num-queries]]\n", stderr);
+		return 1;
+	}
+
+	std::srand(0x1337);
+
+	dht_settings sett;
+	sett.enforce_node_id = false;
+	benchmark_socket sock;
+	benchmark_observer observer;
+	counters cnt;
+	node n(&sock, sett, random_id(), &observer, cnt);
+
+	for (int i = 0; i < num_nodes; ++i)
+		n.m_table.node_seen(random_id(), random_ep(), 50);
+
+	boost::tuple<int, int, int> const size = n.size();
+	fprintf(stderr, "routing table: %d nodes, %d replacements, %d buckets\n"
+		, size.get<0>(), size.get<1>(), n.m_table.num_active_buckets());
+
+	// a mix of find_node and get_peers queries from different endpoints
+	std::vector<std::string> queries;
+	std::vector<udp::endpoint> sources;
+	for (int i = 0; i < 1000; ++i)
+	{
+		queries.push_back(encode_query(i & 1));
+		sources.push_back(random_ep());
+	}
+
+	std::vector<bdecode_node> decoded(queries.size());
+	for (int i = 0; i < int(queries.size()); ++i)
+	{
+		error_code ec;
+		bdecode(queries[i].c_str(), queries[i].c_str() + queries[i].size()
+			, decoded[i], ec);
+		if (ec)
+		{
+			fprintf(stderr, "failed to decode query: %s\n", ec.message().c_str());
+			return 1;
+		}
+	}
+
+	time_point const start = clock_type::now();
+
+	for (int i = 0; i < num_queries; ++i)
+	{
+		int const q = i % int(queries.size());
+		msg m(decoded[q], sources[q]);
+		n.incoming(m);
+	}
+
+	time_point const stop = clock_type::now();
+
+	boost::int64_t const us = total_microseconds(stop - start);
+	fprintf(stderr, "%d queries (%d responses) in %d ms, %d queries/s\n"
+		, num_queries, sock.sent, int(us / 1000)
+		, int(boost::int64_t(num_queries) * 1000000 / (std::max)(us, boost::int64_t(1))));
+
+	return 0;
+}
+
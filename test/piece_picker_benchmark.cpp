@@ -0,0 +1,175 @@
+/*
+
+Copyright (c) 2015, Arvid Norberg
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions
+are met:
+
+    * Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright
+      notice, this list of conditions and the following disclaimer in
+      the documentation and/or other materials provided with the distribution.
+    * Neither the name of the author nor the names of its
+      contributors may be used to endorse or promote products derived
+      from this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+// replays the piece availability traffic of a large swarm against the piece
+// picker. Peers connect and send a bitfield, announce pieces with have
+// messages as they download them and eventually disconnect. Every now and
+// then pieces are picked, like a peer_connection would when it's unchoked.
+
+#include "libtorrent/piece_picker.hpp"
+#include "libtorrent/bitfield.hpp"
+#include "libtorrent/performance_counters.hpp"
+#include "libtorrent/time.hpp"
+
+#include <vector>
+#include <cstdio>
+#include <cstdlib>
+
+using namespace libtorrent;
+
+namespace {
+
+	struct swarm_peer
+	{
+		swarm_peer(): num_have(0), seed(false) {}
+		bitfield have;
+		int num_have;
+		// true if the peer was added to the picker as a seed, with
+		// inc_refcount_all(). A peer that ends up with every piece through
+		// have messages is still counted per piece
+		bool seed;
+	};
+
+	int random_int(int limit)
+	{
+		return int((boost::uint64_t(std::rand()) * RAND_MAX
+			+ std::rand()) % limit);
+	}
+
+	void connect_peer(piece_picker& p, swarm_peer& peer, int num_pieces)
+	{
+		// most peers that connect have very few pieces, some have most of them
+		// and a few are seeds
+		int const kind = random_int(10);
+		if (kind == 0)
+		{
+			peer.have.resize(num_pieces, true);
+			peer.num_have = num_pieces;
+			peer.seed = true;
+			p.inc_refcount_all(&peer);
+			return;
+		}
+
+		peer.have.resize(num_pieces, false);
+		peer.have.clear_all();
+		int const fill = kind < 7 ? random_int(100) : random_int(num_pieces);
+		for (int i = 0; i < fill; ++i) peer.have.set_bit(random_int(num_pieces));
+		peer.num_have = peer.have.count();
+		peer.seed = false;
+		p.inc_refcount(peer.have, &peer);
+	}
+
+	void disconnect_peer(piece_picker& p, swarm_peer& peer)
+	{
+		if (peer.seed) p.dec_refcount_all(&peer);
+		else p.dec_refcount(peer.have, &peer);
+		peer.have.clear();
+		peer.num_have = 0;
+		peer.seed = false;
+	}
+}
+
+int main(int argc, char* argv[])
+{
+	int num_pieces = 100000;
+	int num_peers = 1000;
+	int num_events = 200000;
+	if (argc > 1) num_pieces = atoi(argv[1]);
+	if (argc > 2) num_peers = atoi(argv[2]);
+	if (argc > 3) num_events = atoi(argv[3]);
+
+	if (argc > 4 || num_pieces <= 0 || num_peers <= 0 || num_events <= 0)
+	{
+		fputs("usage: piece_picker_benchmark [num-pieces [num-peers [num-events]]]\n"
+			, stderr);
+		return 1;
+	}
+
+	std::srand(0x1337);
+
+	piece_picker p;
+	p.init(16, 16, num_pieces);
+
+	std::vector<swarm_peer> peers(num_peers);
+	for (int i = 0; i < num_peers; ++i)
+		connect_peer(p, peers[i], num_pieces);
+
+	std::vector<piece_block> picked;
+	std::vector<int> const suggested;
+	counters pc;
+
+	int num_haves = 0;
+	int num_churn = 0;
+	int num_picks = 0;
+
+	time_point const start = clock_type::now();
+
+	for (int i = 0; i < num_events; ++i)
+	{
+		swarm_peer& peer = peers[random_int(num_peers)];
+		int const action = random_int(1000);
+
+		if (action < 5)
+		{
+			// the peer disconnects and a new one takes its place
+			disconnect_peer(p, peer);
+			connect_peer(p, peer, num_pieces);
+			++num_churn;
+		}
+		else if (action < 50)
+		{
+			// this is a peer we're downloading from
+			picked.clear();
+			p.pick_pieces(peer.have, picked, 16, 0, &peer
+				, piece_picker::rarest_first, suggested, num_peers, pc);
+			++num_picks;
+		}
+		else if (peer.num_have < num_pieces)
+		{
+			int const piece = random_int(num_pieces);
+			if (peer.have.get_bit(piece)) continue;
+			peer.have.set_bit(piece);
+			++peer.num_have;
+			p.inc_refcount(piece, &peer);
+			++num_haves;
+		}
+	}
+
+	time_point const stop = clock_type::now();
+
+	fprintf(stderr, "%d pieces, %d peers: %d have, %d reconnects, %d picks "
+		"in %d ms\n", num_pieces, num_peers, num_haves, num_churn, num_picks
+		, int(total_milliseconds(stop - start)));
+
+	return 0;
+}
+
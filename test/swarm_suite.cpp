@@ -47,13 +47,14 @@ void test_swarm(int flags)
 	using namespace libtorrent;
 	namespace lt = libtorrent;
 
-	fprintf(stderr, "\n\n ==== TEST SWARM === %s%s%s%s%s%s ===\n\n\n"
+	fprintf(stderr, "\n\n ==== TEST SWARM === %s%s%s%s%s%s%s ===\n\n\n"
 		, (flags & super_seeding) ? "super-seeding ": ""
 		, (flags & strict_super_seeding) ? "strict-super-seeding ": ""
 		, (flags & seed_mode) ? "seed-mode ": ""
 		, (flags & time_critical) ? "time-critical ": ""
 		, (flags & suggest) ? "suggest ": ""
 		, (flags & explicit_cache) ? "explicit-cache ": ""
+		, (flags & sendfile) ? "sendfile ": ""
 		);
 
 	// in case the previous run was terminated
@@ -106,13 +107,31 @@ void test_swarm(int flags)
 	pack.set_str(settings_pack::listen_interfaces, "0.0.0.0:48000");
 	pack.set_int(settings_pack::max_retry_port_bind, 1000);
 
-	pack.set_int(settings_pack::out_enc_policy, settings_pack::pe_forced);
-	pack.set_int(settings_pack::in_enc_policy, settings_pack::pe_forced);
+	if (flags & sendfile)
+	{
+		// sendfile() is only used for unencrypted TCP connections
+		pack.set_bool(settings_pack::use_sendfile, true);
+		pack.set_bool(settings_pack::enable_outgoing_utp, false);
+		pack.set_bool(settings_pack::enable_incoming_utp, false);
+		pack.set_int(settings_pack::out_enc_policy, settings_pack::pe_disabled);
+		pack.set_int(settings_pack::in_enc_policy, settings_pack::pe_disabled);
+	}
+	else
+	{
+		pack.set_int(settings_pack::out_enc_policy, settings_pack::pe_forced);
+		pack.set_int(settings_pack::in_enc_policy, settings_pack::pe_forced);
+	}
+
+	// the seed has no read cache to serve blocks from, so every piece
+	// it uploads goes through sendfile()
+	if (flags & sendfile) pack.set_bool(settings_pack::use_read_cache, false);
 
 	lt::session ses1(pack);
 
 	ses1.apply_settings(pack);
 
+	if (flags & sendfile) pack.set_bool(settings_pack::use_read_cache, true);
+
 	pack.set_int(settings_pack::download_rate_limit, rate_limit / 2);
 	pack.set_int(settings_pack::upload_rate_limit, rate_limit);
 	lt::session ses2(pack);
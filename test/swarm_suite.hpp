@@ -39,7 +39,8 @@ enum test_flags_t
 	seed_mode = 4,
 	time_critical = 8,
 	suggest = 16,
-	explicit_cache = 32
+	explicit_cache = 32,
+	sendfile = 64
 };
 
 void EXPORT test_swarm(int flags = 0);
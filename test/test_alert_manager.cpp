@@ -315,3 +315,45 @@ TORRENT_TEST(alert_mask)
 	TEST_CHECK(!mgr.should_post<torrent_paused_alert>());
 }
 
+
+TORRENT_TEST(session_stats_delta)
+{
+	alert_manager mgr(100, 0xffffffff);
+	counters cnt;
+	std::vector<boost::int64_t> last(counters::num_counters, 0);
+
+	cnt.inc_stats_counter(counters::on_read_counter, 5);
+	cnt.set_value(counters::num_checking_torrents, 3);
+	mgr.emplace_alert<session_stats_delta_alert>(cnt, &last[0]);
+
+	std::vector<alert*> alerts;
+	int num_resume = 0;
+	mgr.get_all(alerts, num_resume);
+	TEST_EQUAL(alerts.size(), 1);
+	session_stats_delta_alert const* a
+		= alert_cast<session_stats_delta_alert>(alerts[0]);
+	TEST_CHECK(a);
+	TEST_EQUAL(a->num_values(), 2);
+	TEST_EQUAL(a->metric_index(0), counters::on_read_counter);
+	TEST_EQUAL(a->value(0), 5);
+	TEST_EQUAL(a->metric_index(1), counters::num_checking_torrents);
+	TEST_EQUAL(a->value(1), 3);
+
+	// nothing changed since the last delta
+	mgr.emplace_alert<session_stats_delta_alert>(cnt, &last[0]);
+	mgr.get_all(alerts, num_resume);
+	TEST_EQUAL(alerts.size(), 1);
+	a = alert_cast<session_stats_delta_alert>(alerts[0]);
+	TEST_CHECK(a);
+	TEST_EQUAL(a->num_values(), 0);
+
+	cnt.set_value(counters::num_checking_torrents, 1);
+	mgr.emplace_alert<session_stats_delta_alert>(cnt, &last[0]);
+	mgr.get_all(alerts, num_resume);
+	TEST_EQUAL(alerts.size(), 1);
+	a = alert_cast<session_stats_delta_alert>(alerts[0]);
+	TEST_CHECK(a);
+	TEST_EQUAL(a->num_values(), 1);
+	TEST_EQUAL(a->metric_index(0), counters::num_checking_torrents);
+	TEST_EQUAL(a->value(0), 1);
+}
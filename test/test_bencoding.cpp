@@ -105,6 +105,20 @@ TORRENT_TEST(bencoding)
 		TEST_CHECK(decode(encode(e)) == e);
 	}
 
+	// ** preformatted **
+	{
+		char const info[] = "d4:name4:teste";
+		entry e(entry::dictionary_t);
+		e["info"] = entry::preformatted_type(info, info + sizeof(info) - 1);
+		e["spam"] = entry("eggs");
+		TEST_CHECK(encode(e) == "d4:infod4:name4:teste4:spam4:eggse");
+
+		entry copy(e);
+		TEST_CHECK(copy == e);
+		TEST_CHECK(copy["info"].type() == entry::preformatted_t);
+		TEST_CHECK(decode(encode(e))["info"]["name"].string() == "test");
+	}
+
 #ifndef TORRENT_NO_DEPRECATE
 	{
 		char b[] = "i12453e";
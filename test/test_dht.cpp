@@ -438,6 +438,48 @@ struct obs : dht::dht_observer
 		, udp::endpoint node) TORRENT_OVERRIDE {}
 };
 
+TORRENT_TEST(dht_peer_limit)
+{
+	dht_settings sett;
+	sett.max_peers = 10;
+	sett.enforce_node_id = false;
+	mock_socket s;
+	obs observer;
+	counters cnt;
+	dht::node node(&s, sett, node_id(0), &observer, cnt);
+
+	bdecode_node response;
+	for (int i = 0; i < 20; ++i)
+	{
+		udp::endpoint source(rand_v4(), 6000);
+		send_dht_request(node, "get_peers", source, &response, "10"
+			, "01010101010101010101");
+		std::string token = response.dict_find_dict("r")
+			.dict_find_string_value("token");
+		TEST_CHECK(!token.empty());
+		send_dht_request(node, "announce_peer", source, &response, "10"
+			, "01010101010101010101", "test", token, 8080);
+	}
+
+	// only the 10 most recent peers are kept
+	TEST_EQUAL(node.num_torrents(), 1);
+	TEST_EQUAL(node.num_peers(), 10);
+
+	// announcing from the same endpoint again refreshes the peer instead of
+	// adding another entry
+	udp::endpoint source(rand_v4(), 6000);
+	for (int i = 0; i < 2; ++i)
+	{
+		send_dht_request(node, "get_peers", source, &response, "10"
+			, "01010101010101010101");
+		std::string token = response.dict_find_dict("r")
+			.dict_find_string_value("token");
+		send_dht_request(node, "announce_peer", source, &response, "10"
+			, "01010101010101010101", "test", token, 8080);
+	}
+	TEST_EQUAL(node.num_peers(), 10);
+}
+
 // TODO: test obfuscated_get_peers
 TORRENT_TEST(dht)
 {
@@ -36,6 +36,7 @@ POSSIBILITY OF SUCH DAMAGE.
 #include <string.h> // for strcmp
 #include <vector>
 #include <set>
+#include <algorithm> // for count
 
 using namespace libtorrent;
 
@@ -308,3 +309,78 @@ TORRENT_TEST(file)
 	f.close();
 }
 
+TORRENT_TEST(file_memory_map)
+{
+	error_code ec;
+	{
+		file f;
+		TEST_CHECK(f.open("test_file_mmap", file::read_write, ec));
+		TEST_CHECK(!ec);
+		file::iovec_t b = {(void*)"0123456789", 10};
+		TEST_EQUAL(f.writev(0, &b, 1, ec), 10);
+		TEST_CHECK(!ec);
+	}
+
+	file f;
+	TEST_CHECK(f.open("test_file_mmap", file::read_only | file::memory_map, ec));
+	if (ec)
+		fprintf(stderr, "open failed: [%s] %s\n", ec.category().name(), ec.message().c_str());
+	TEST_CHECK(!ec);
+
+	// a read spanning multiple buffers, at an offset
+	char buf1[3] = {0};
+	char buf2[5] = {0};
+	file::iovec_t b[2] = {{buf1, 3}, {buf2, 4}};
+	TEST_EQUAL(f.readv(2, b, 2, ec), 7);
+	TEST_CHECK(!ec);
+	TEST_CHECK(memcmp(buf1, "234", 3) == 0);
+	TEST_CHECK(strcmp(buf2, "5678") == 0);
+
+	// a read past the end of the file is a short read
+	char buf3[10] = {0};
+	file::iovec_t b3 = {buf3, 10};
+	TEST_EQUAL(f.readv(6, &b3, 1, ec), 4);
+	TEST_CHECK(!ec);
+	TEST_CHECK(memcmp(buf3, "6789", 4) == 0);
+	f.close();
+
+	remove("test_file_mmap", ec);
+}
+
+TORRENT_TEST(file_memory_map_truncated)
+{
+	error_code ec;
+	std::vector<char> data(0x10000, 'x');
+	file w;
+	TEST_CHECK(w.open("test_file_mmap_trunc", file::read_write, ec));
+	TEST_CHECK(!ec);
+	file::iovec_t b = {&data[0], data.size()};
+	TEST_EQUAL(w.writev(0, &b, 1, ec), int(data.size()));
+	TEST_CHECK(!ec);
+
+	file f;
+	TEST_CHECK(f.open("test_file_mmap_trunc", file::read_only | file::memory_map, ec));
+	TEST_CHECK(!ec);
+
+	// truncate the file behind the mapping's back. Reading the pages past
+	// the new end of the file raises SIGBUS, which must turn into an error
+	w.set_size(0x1000, ec);
+	TEST_CHECK(!ec);
+	w.close();
+
+	std::vector<char> buf(0x4000);
+	file::iovec_t rb = {&buf[0], buf.size()};
+	TEST_EQUAL(f.readv(0x8000, &rb, 1, ec), -1);
+	TEST_CHECK(ec);
+	ec.clear();
+
+	// the part that's still there can be read
+	rb.iov_len = 0x1000;
+	TEST_EQUAL(f.readv(0, &rb, 1, ec), 0x1000);
+	TEST_CHECK(!ec);
+	TEST_CHECK(std::count(buf.begin(), buf.begin() + 0x1000, 'x') == 0x1000);
+	f.close();
+
+	remove("test_file_mmap_trunc", ec);
+}
+
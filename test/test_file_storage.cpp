@@ -220,3 +220,44 @@ TORRENT_TEST(file_path_hash)
 // TODO: test pad_files
 // TODO: test reorder_file (make sure internal_file_entry::swap() is used)
 
+
+TORRENT_TEST(shared_paths)
+{
+	file_storage st;
+	st.add_file(combine_path("test", combine_path("a", "1")), 10);
+	st.add_file(combine_path("test", combine_path("a", "2")), 10);
+	st.add_file(combine_path("test", combine_path("b", "3")), 10);
+	st.add_file(combine_path("test", combine_path("a", "4")), 10);
+	st.add_file(combine_path("test", "5"), 10);
+	st.add_file(combine_path("test", "6"), 10);
+
+	// files in the same directory share the path entry
+	TEST_EQUAL(st.paths().size(), 3);
+	TEST_EQUAL(st.file_path(3, ""), combine_path("test", combine_path("a", "4")));
+	TEST_EQUAL(st.file_path(5, ""), combine_path("test", "6"));
+
+	// the copy has to find the existing paths too
+	file_storage st2(st);
+	st2.add_file(combine_path("test", combine_path("b", "7")), 10);
+	TEST_EQUAL(st2.paths().size(), 3);
+	TEST_EQUAL(st2.file_path(6, ""), combine_path("test", combine_path("b", "7")));
+
+	st2.rename_file(0, combine_path("test", combine_path("c", "1")));
+	TEST_EQUAL(st2.paths().size(), 4);
+	TEST_EQUAL(st2.file_path(0, ""), combine_path("test", combine_path("c", "1")));
+
+	// assign a file_storage with the same number of paths, but different
+	// ones. The assigned-to object must not keep finding its old paths
+	file_storage st3;
+	st3.add_file(combine_path("test", combine_path("x", "1")), 10);
+	st3.add_file(combine_path("test", combine_path("y", "2")), 10);
+	st3.add_file(combine_path("test", combine_path("z", "3")), 10);
+	TEST_EQUAL(st3.paths().size(), 3);
+	st3 = st;
+	st3.add_file(combine_path("test", combine_path("x", "7")), 10);
+	TEST_EQUAL(st3.paths().size(), 4);
+	TEST_EQUAL(st3.file_path(6, ""), combine_path("test", combine_path("x", "7")));
+	st3.add_file(combine_path("test", combine_path("a", "8")), 10);
+	TEST_EQUAL(st3.paths().size(), 4);
+	TEST_EQUAL(st3.file_path(7, ""), combine_path("test", combine_path("a", "8")));
+}
@@ -31,6 +31,7 @@ POSSIBILITY OF SUCH DAMAGE.
 */
 
 #include "libtorrent/hasher.hpp"
+#include "libtorrent/sha1.hpp"
 #include <boost/lexical_cast.hpp>
 #include "libtorrent/hex.hpp" // from_hex
 
@@ -76,3 +77,28 @@ TORRENT_TEST(hasher)
 	}
 }
 
+// the built-in SHA-1 implementation, fed with each test vector as one large
+// buffer, to cover hashing many blocks in a single call
+TORRENT_TEST(internal_sha1)
+{
+	using namespace libtorrent;
+
+	for (int test = 0; test < 4; ++test)
+	{
+		std::string buf;
+		for (int i = 0; i < repeat_count[test]; ++i)
+			buf += test_array[test];
+
+		sha_ctx ctx;
+		SHA1_init(&ctx);
+		SHA1_update(&ctx, reinterpret_cast<boost::uint8_t const*>(buf.data())
+			, buf.size());
+		sha1_hash digest;
+		SHA1_final(digest.begin(), &ctx);
+
+		sha1_hash result;
+		from_hex(result_array[test], 40, (char*)&result[0]);
+		TEST_CHECK(result == digest);
+	}
+}
+
@@ -237,6 +237,37 @@ TORRENT_TEST(swap)
 	TEST_EQUAL(ptrs[2]->type(), 1);
 }
 
+#ifndef BOOST_NO_CXX11_VARIADIC_TEMPLATES
+// test emplace_back of heterogeneous types
+TORRENT_TEST(emplace_back)
+{
+	using namespace libtorrent;
+
+	heterogeneous_queue<A> q;
+	B* b = q.emplace_back<B>(0, 1);
+	TEST_EQUAL(b->a, 0);
+	TEST_EQUAL(b->b, 1);
+	C* c = q.emplace_back<C>(2, 3);
+	TEST_EQUAL(c->a, 2);
+	TEST_EQUAL(c->c[0], 3);
+	q.emplace_back<B>(4, 5);
+
+	TEST_EQUAL(q.size(), 3);
+
+	std::vector<A*> ptrs;
+	q.get_pointers(ptrs);
+	TEST_EQUAL(int(ptrs.size()), q.size());
+
+	TEST_EQUAL(ptrs[0]->type(), 1);
+	TEST_EQUAL(ptrs[1]->type(), 2);
+	TEST_EQUAL(ptrs[2]->type(), 1);
+
+	TEST_EQUAL(static_cast<B*>(ptrs[0])->b, 1);
+	TEST_EQUAL(static_cast<B*>(ptrs[2])->a, 4);
+	TEST_EQUAL(static_cast<B*>(ptrs[2])->b, 5);
+}
+#endif
+
 // test destruction
 TORRENT_TEST(destruction)
 {
@@ -32,6 +32,7 @@ POSSIBILITY OF SUCH DAMAGE.
 
 #include <algorithm>
 #include <iostream>
+#include <cstring> // for memcmp
 
 #include "libtorrent/hasher.hpp"
 #include "libtorrent/pe_crypto.hpp"
@@ -254,3 +255,26 @@ TORRENT_TEST(test_pe_crypto)
 #endif
 }
 
+
+TORRENT_TEST(rc4)
+{
+#if !defined(TORRENT_DISABLE_ENCRYPTION) && !defined(TORRENT_DISABLE_EXTENSIONS)
+	// test vector from RFC 6229 (40 bit key, key stream offset 0)
+	unsigned char const key[] = { 0x01, 0x02, 0x03, 0x04, 0x05 };
+	unsigned char const expected[] = {
+		0xb2, 0x39, 0x63, 0x05, 0xf0, 0x3d, 0xc0, 0x27
+		, 0xcc, 0xc3, 0x52, 0x4a, 0x0a, 0x11, 0x18, 0xa8
+		, 0x69, 0x82, 0x94, 0x4f, 0x18, 0xfc, 0x82, 0xd5
+		, 0x89, 0xc4, 0x03, 0xa4, 0x7a, 0x0d, 0x09, 0x19 };
+
+	rc4 state;
+	rc4_init(key, sizeof(key), &state);
+
+	// encrypting zeroes yields the key stream. Do it in uneven chunks to
+	// make sure the state carries over correctly
+	unsigned char buf[32] = {0};
+	TEST_EQUAL(rc4_encrypt(buf, 7, &state), 7);
+	TEST_EQUAL(rc4_encrypt(buf + 7, 25, &state), 25);
+	TEST_CHECK(memcmp(buf, expected, sizeof(expected)) == 0);
+#endif
+}
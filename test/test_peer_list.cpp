@@ -938,6 +938,36 @@ TORRENT_TEST(new_peer_size_limit)
 		, 5);
 }
 
+// test that a peer waiting for its reconnect timeout is picked again once
+// the timeout expires, even though the peer list stops scanning for it in
+// the meantime
+TORRENT_TEST(reconnect_timeout)
+{
+	torrent_state st = init_state(allocator, ext_ip);
+	mock_torrent t(&st);
+	peer_list p;
+	t.m_p = &p;
+
+	torrent_peer* peer = add_peer(p, st, ep("10.0.0.2", 3000));
+	connect_peer(p, t, st);
+	TEST_EQUAL(p.num_connect_candidates(), 0);
+
+	// the connection was initiated at session time 100 and is then closed
+	peer->last_connected = 100;
+	t.m_connections[0]->disconnect(error_code(), op_bittorrent);
+	TEST_EQUAL(p.num_connect_candidates(), 1);
+
+	TEST_CHECK(p.connect_one_peer(101, &st) == NULL);
+	TEST_CHECK(p.connect_one_peer(159, &st) == NULL);
+	TEST_EQUAL(p.connect_one_peer(100 + st.min_reconnect_time, &st), peer);
+	st.erased.clear();
+
+	// a new peer is picked up right away
+	torrent_peer* peer2 = add_peer(p, st, ep("10.0.0.3", 3000));
+	TEST_EQUAL(p.connect_one_peer(161, &st), peer2);
+	st.erased.clear();
+}
+
 // TODO: test erasing peers
 // TODO: test update_peer_port with allow_multiple_connections_per_ip and without
 // TODO: test add i2p peers
@@ -1860,3 +1860,42 @@ TORRENT_TEST(piece_picker)
 		TEST_EQUAL(picked[0].piece_index, 4);
 }
 
+
+TORRENT_TEST(refcount_sparse_bitfield)
+{
+	// make sure pieces are counted correctly when the bitfield spans several
+	// words, some of which have no bits set. Enough bits are set to take the
+	// path that updates the counters and marks the picker dirty
+	const int num_pieces = 1000;
+	piece_picker p;
+	p.init(blocks_per_piece, blocks_per_piece, num_pieces);
+
+	bitfield bits(num_pieces, false);
+	for (int i = 0; i < 100; ++i) bits.set_bit(i * 7 + (i % 3));
+	bits.set_bit(num_pieces - 1);
+
+	p.inc_refcount(bits, &tmp0);
+	p.inc_refcount(bits, &tmp1);
+
+	std::vector<int> avail;
+	p.get_availability(avail);
+	TEST_EQUAL(int(avail.size()), num_pieces);
+	for (int i = 0; i < num_pieces; ++i)
+		TEST_EQUAL(avail[i], bits[i] ? 2 : 0);
+
+	p.dec_refcount(bits, &tmp0);
+	p.get_availability(avail);
+	for (int i = 0; i < num_pieces; ++i)
+		TEST_EQUAL(avail[i], bits[i] ? 1 : 0);
+
+	// the picker should only ever pick pieces the peer has
+	bitfield one(num_pieces, false);
+	one.set_bit(num_pieces - 1);
+	std::vector<piece_block> picked;
+	counters pc;
+	p.pick_pieces(one, picked, 1, 0, &tmp0, piece_picker::rarest_first
+		, empty_vector, 20, pc);
+	TEST_EQUAL(int(picked.size()), 1);
+	TEST_EQUAL(picked[0].piece_index, num_pieces - 1);
+}
+
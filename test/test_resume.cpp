@@ -35,6 +35,7 @@ POSSIBILITY OF SUCH DAMAGE.
 #include "libtorrent/torrent_info.hpp"
 #include "libtorrent/random.hpp"
 #include "libtorrent/create_torrent.hpp"
+#include "libtorrent/alert_types.hpp"
 
 #include <boost/make_shared.hpp>
 
@@ -175,6 +176,36 @@ void default_tests(torrent_status const& s)
 	TEST_EQUAL(s.completed_time, 1348);
 }
 
+namespace {
+
+entry save_resume_data_with_flags(int flags)
+{
+	libtorrent::session ses;
+
+	boost::shared_ptr<torrent_info> ti = generate_torrent();
+
+	add_torrent_params p;
+	p.ti = ti;
+	p.save_path = ".";
+	torrent_handle h = ses.add_torrent(p);
+
+	h.save_resume_data(flags);
+	alert const* a = wait_for_alert(ses, save_resume_data_alert::alert_type);
+	save_resume_data_alert const* ra = alert_cast<save_resume_data_alert>(a);
+	TEST_CHECK(ra);
+	if (ra == NULL || !ra->resume_data) return entry();
+
+	entry rd = *ra->resume_data;
+	std::vector<char> info;
+	bencode(std::back_inserter(info), rd["info"]);
+	TEST_EQUAL(int(info.size()), ti->metadata_size());
+	TEST_CHECK(info.size() > 0 && std::memcmp(&info[0], ti->metadata().get()
+		, info.size()) == 0);
+	return rd;
+}
+
+} // anonymous namespace
+
 TORRENT_TEST(resume)
 {
 	torrent_status s;
@@ -342,4 +373,14 @@ TORRENT_TEST(resume)
 	// and trackers for instance
 }
 
-
+TORRENT_TEST(resume_info_dict)
+{
+	// by default, the info-dict is expanded into a dictionary
+	entry rd = save_resume_data_with_flags(torrent_handle::save_info_dict);
+	TEST_EQUAL(rd["info"].type(), entry::dictionary_t);
+
+	// unless the client asks for the preformatted one
+	rd = save_resume_data_with_flags(torrent_handle::save_info_dict
+		| torrent_handle::preformatted_info_dict);
+	TEST_EQUAL(rd["info"].type(), entry::preformatted_t);
+}
@@ -88,3 +88,107 @@ TORRENT_TEST(session)
 	// the session object
 }
 
+
+namespace {
+
+// posts a state update and returns the info-hashes of the torrents in it
+std::vector<sha1_hash> post_state_updates(lt::session& ses)
+{
+	std::vector<sha1_hash> ret;
+	ses.post_torrent_updates();
+	alert const* a = wait_for_alert(ses, state_update_alert::alert_type
+		, "post_state_updates");
+	TEST_CHECK(a);
+	state_update_alert const* su = alert_cast<state_update_alert>(a);
+	if (su == NULL) return ret;
+	for (std::vector<torrent_status>::const_iterator i = su->status.begin()
+		, end(su->status.end()); i != end; ++i)
+		ret.push_back(i->info_hash);
+	return ret;
+}
+
+} // anonymous namespace
+
+TORRENT_TEST(max_state_updates)
+{
+	settings_pack p;
+	p.set_int(settings_pack::alert_mask, alert::status_notification);
+	p.set_bool(settings_pack::enable_dht, false);
+	p.set_bool(settings_pack::enable_lsd, false);
+	p.set_bool(settings_pack::enable_upnp, false);
+	p.set_bool(settings_pack::enable_natpmp, false);
+	lt::session ses(p);
+
+	// paused, non auto-managed torrents without any files on disk settle in
+	// the downloading state and won't post state updates on their own
+	torrent_handle h[3];
+	sha1_hash ih[3];
+	for (int i = 0; i < 3; ++i)
+	{
+		add_torrent_params atp;
+		atp.ti = create_torrent(NULL, 16 * 1024, 13 + i, false);
+		atp.save_path = ".";
+		atp.flags |= add_torrent_params::flag_paused;
+		atp.flags &= ~add_torrent_params::flag_auto_managed;
+		error_code ec;
+		h[i] = ses.add_torrent(atp, ec);
+		TEST_CHECK(!ec);
+		ih[i] = atp.ti->info_hash();
+	}
+
+	for (int i = 0; i < 3; ++i)
+	{
+		for (int k = 0; k < 100; ++k)
+		{
+			if (h[i].status().state == torrent_status::downloading) break;
+			test_sleep(100);
+		}
+		TEST_EQUAL(h[i].status().state, torrent_status::downloading);
+	}
+
+	// flush the updates from adding the torrents
+	TEST_EQUAL(int(post_state_updates(ses).size()), 3);
+
+	settings_pack sett;
+	sett.set_int(settings_pack::max_state_updates, 1);
+	ses.apply_settings(sett);
+
+	// every torrent is posted once, in the order they were updated
+	for (int i = 0; i < 3; ++i) h[i].set_max_uploads(5);
+	for (int i = 0; i < 3; ++i)
+	{
+		std::vector<sha1_hash> st = post_state_updates(ses);
+		TEST_EQUAL(int(st.size()), 1);
+		if (st.size() == 1) TEST_CHECK(st[0] == ih[i]);
+	}
+	TEST_EQUAL(int(post_state_updates(ses).size()), 0);
+
+	// a torrent updated again while it's still queued keeps its place and
+	// is only posted once. One that has been posted goes to the back
+	for (int i = 0; i < 3; ++i) h[i].set_max_uploads(6);
+	std::vector<sha1_hash> st = post_state_updates(ses);
+	TEST_EQUAL(int(st.size()), 1);
+	if (st.size() == 1) TEST_CHECK(st[0] == ih[0]);
+	h[1].set_max_uploads(7);
+	h[0].set_max_uploads(7);
+	int const order[] = { 1, 2, 0 };
+	for (int i = 0; i < 3; ++i)
+	{
+		st = post_state_updates(ses);
+		TEST_EQUAL(int(st.size()), 1);
+		if (st.size() == 1) TEST_CHECK(st[0] == ih[order[i]]);
+	}
+	TEST_EQUAL(int(post_state_updates(ses).size()), 0);
+
+	// a removed torrent is dropped from the queue without reordering the
+	// rest of it
+	for (int i = 0; i < 3; ++i) h[i].set_max_uploads(8);
+	ses.remove_torrent(h[0]);
+	for (int i = 1; i < 3; ++i)
+	{
+		st = post_state_updates(ses);
+		TEST_EQUAL(int(st.size()), 1);
+		if (st.size() == 1) TEST_CHECK(st[0] == ih[i]);
+	}
+	TEST_EQUAL(int(post_state_updates(ses).size()), 0);
+}
@@ -969,3 +969,179 @@ TORRENT_TEST(storage)
 	std::for_each(test_paths.begin(), test_paths.end(), boost::bind(&run_test, _1, false));
 }
 
+
+void on_piece_hashed(int piece, std::vector<int>* pieces)
+{
+	pieces->push_back(piece);
+}
+
+TORRENT_TEST(set_piece_hashes_threads)
+{
+	std::string const test_path = combine_path(current_working_directory()
+		, "tmp_set_piece_hashes");
+	error_code ec;
+	remove_all(test_path, ec);
+	create_directory(test_path, ec);
+	create_directory(combine_path(test_path, "temp_storage"), ec);
+
+	// lots of small pieces, spread over files of uneven sizes, to make the
+	// disk threads likely to complete the hash jobs out of order
+	static const int file_sizes[] = { 100000, 5, 16 * 1024 * 7 + 1, 300000
+		, 1, 45000, 250000, 16 * 1024, 3, 180000 };
+	int const num_files = sizeof(file_sizes) / sizeof(file_sizes[0]);
+	create_random_files(combine_path(test_path, "temp_storage"), file_sizes
+		, num_files);
+
+	file_storage fs;
+	add_files(fs, combine_path(test_path, "temp_storage"));
+
+	// the reference piece hashes, computed on a single thread
+	libtorrent::create_torrent ref(fs, 0x4000);
+	std::vector<int> pieces;
+	set_piece_hashes(ref, test_path, boost::bind(&on_piece_hashed, _1
+		, &pieces), 1, ec);
+	TEST_CHECK(!ec);
+	TEST_EQUAL(int(pieces.size()), ref.num_pieces());
+	std::string const ref_hashes = ref.generate()["info"]["pieces"].string();
+
+	// with 6 threads, two of them are hasher threads and the generic ones
+	// pick up hash jobs from their queue
+	int const num_threads[] = { 3, 3, 3, 6, 6, 6 };
+	for (int i = 0; i < int(sizeof(num_threads) / sizeof(num_threads[0])); ++i)
+	{
+		libtorrent::create_torrent t(fs, 0x4000);
+		pieces.clear();
+		set_piece_hashes(t, test_path, boost::bind(&on_piece_hashed, _1
+			, &pieces), num_threads[i], ec);
+		TEST_CHECK(!ec);
+
+		// every piece is reported exactly once, in order
+		TEST_EQUAL(int(pieces.size()), t.num_pieces());
+		for (int k = 0; k < int(pieces.size()); ++k)
+			TEST_EQUAL(pieces[k], k);
+
+		TEST_CHECK(t.generate()["info"]["pieces"].string() == ref_hashes);
+	}
+
+	remove_all(test_path, ec);
+}
+
+void on_block_written(disk_io_job const* j, int* num_written)
+{
+	TEST_EQUAL(j->ret, j->d.io.buffer_size);
+	TEST_CHECK(!j->error);
+	++*num_written;
+}
+
+void on_files_released(disk_io_job const* j, bool* done)
+{
+	TEST_CHECK(!j->error);
+	*done = true;
+}
+
+TORRENT_TEST(flush_coalesced_pieces)
+{
+	std::string const test_path = combine_path(current_working_directory()
+		, "tmp_flush_pieces");
+	error_code ec;
+	remove_all(test_path, ec);
+	create_directory(test_path, ec);
+
+	// 4 blocks per piece. The first file ends in the middle of the third
+	// block of piece 1 and the last piece is only 2 blocks, the last of
+	// which is short
+	int const block_size = 16 * 1024;
+	int const piece_size = 4 * block_size;
+	int const total_size = 3 * piece_size + 20000;
+	file_storage fs;
+	fs.add_file("temp_storage/test1.tmp", 100000);
+	fs.add_file("temp_storage/test2.tmp", total_size - 100000);
+	fs.set_piece_length(piece_size);
+	fs.set_num_pieces(4);
+
+	libtorrent::asio::io_service ios;
+	counters cnt;
+	disk_io_thread io(ios, cnt, NULL);
+
+	// with hash checks disabled, the dirty blocks stay in the cache until
+	// the storage is flushed
+	settings_pack pack;
+	pack.set_int(settings_pack::cache_size, 128);
+	pack.set_bool(settings_pack::disable_hash_checks, true);
+	alert_manager alerts(0, 0);
+	io.set_settings(&pack, alerts);
+	io.set_num_threads(1);
+
+	storage_params p;
+	p.files = &fs;
+	p.path = test_path;
+	p.pool = &io.files();
+	p.mode = storage_mode_sparse;
+	boost::shared_ptr<void> dummy;
+	boost::shared_ptr<piece_manager> pm = boost::make_shared<piece_manager>(
+		new default_storage(p), dummy, &fs);
+
+	// non-contiguous blocks in every piece, where piece 1 block 2 straddles
+	// the file boundary and piece 3 block 1 is the short last block. None
+	// of the pieces is complete, since those are flushed right away
+	static const int blocks[][2] = { {0, 0}, {0, 2}, {0, 3}, {1, 0}, {1, 1}
+		, {1, 2}, {2, 1}, {2, 3}, {3, 1} };
+	int const num_blocks = sizeof(blocks) / sizeof(blocks[0]);
+
+	std::vector<char> expected(total_size, 0);
+	int num_written = 0;
+	for (int i = 0; i < num_blocks; ++i)
+	{
+		peer_request r;
+		r.piece = blocks[i][0];
+		r.start = blocks[i][1] * block_size;
+		int const offset = r.piece * piece_size + r.start;
+		r.length = (std::min)(block_size, total_size - offset);
+
+		char* buf = io.allocate_disk_buffer("test");
+		std::generate(buf, buf + r.length, random_byte);
+		memcpy(&expected[offset], buf, r.length);
+
+		disk_buffer_holder holder(io, buf);
+		io.async_write(pm.get(), r, holder
+			, boost::bind(&on_block_written, _1, &num_written));
+	}
+	io.submit_jobs();
+
+	// releasing the files flushes the write cache of the storage, which
+	// writes all 4 pieces in a single run
+	bool done = false;
+	io.async_release_files(pm.get(), boost::bind(&on_files_released, _1, &done));
+	io.submit_jobs();
+	run_until(ios, done);
+	ios.reset();
+	ios.poll();
+
+	TEST_EQUAL(num_written, num_blocks);
+	TEST_EQUAL(cnt[counters::num_blocks_written], num_blocks);
+	TEST_EQUAL(cnt[counters::num_write_ops], 1);
+
+	for (int i = 0; i < fs.num_pieces(); ++i)
+	{
+		cached_piece_entry* pe = io.cache()->find_piece(pm.get(), i);
+		if (pe == NULL) continue;
+		TEST_EQUAL(pe->num_dirty, 0);
+		TEST_EQUAL(pe->jobs.size(), 0);
+		for (int k = 0; k < pe->blocks_in_piece; ++k)
+			TEST_CHECK(!pe->blocks[k].pending);
+	}
+
+	std::vector<char> on_disk;
+	for (int i = 0; i < fs.num_files(); ++i)
+	{
+		std::ifstream f(combine_path(test_path, fs.file_path(i)).c_str()
+			, std::ios::binary);
+		std::vector<char> file_buf(fs.file_size(i), 0);
+		f.read(&file_buf[0], file_buf.size());
+		on_disk.insert(on_disk.end(), file_buf.begin(), file_buf.end());
+	}
+	TEST_CHECK(on_disk == expected);
+
+	io.set_num_threads(0);
+	remove_all(test_path, ec);
+}
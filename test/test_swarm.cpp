@@ -44,5 +44,8 @@ TORRENT_TEST(swarm)
 
 	// test explicit cache
 	test_swarm(suggest | explicit_cache);
+
+	// send pieces with sendfile()
+	test_swarm(sendfile);
 }
 
@@ -722,3 +722,39 @@ TORRENT_TEST(copy)
 }
 
 
+
+TORRENT_TEST(ssl_cert)
+{
+	using namespace libtorrent;
+
+	entry info;
+	info["pieces"] = "aaaaaaaaaaaaaaaaaaaa";
+	info["name"] = "test";
+	info["piece length"] = 16 * 1024;
+	info["length"] = 3245;
+	info["ssl-cert"] = "-----BEGIN CERTIFICATE-----";
+	entry torrent;
+	torrent["info"] = info;
+
+	std::vector<char> buf;
+	bencode(std::back_inserter(buf), torrent);
+	error_code ec;
+	boost::shared_ptr<torrent_info> a(boost::make_shared<torrent_info>(
+		&buf[0], int(buf.size()), boost::ref(ec)));
+	TEST_CHECK(!ec);
+	TEST_EQUAL(a->ssl_cert(), "-----BEGIN CERTIFICATE-----");
+
+	// the copy must not refer to the original's info section
+	boost::shared_ptr<torrent_info> b(boost::make_shared<torrent_info>(*a));
+	memset(a->metadata().get(), 0, a->metadata_size());
+	a.reset();
+	TEST_EQUAL(b->ssl_cert(), "-----BEGIN CERTIFICATE-----");
+
+	info.dict().erase("ssl-cert");
+	torrent["info"] = info;
+	buf.clear();
+	bencode(std::back_inserter(buf), torrent);
+	torrent_info c(&buf[0], int(buf.size()), ec);
+	TEST_CHECK(!ec);
+	TEST_EQUAL(c.ssl_cert(), "");
+}